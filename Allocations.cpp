@@ -0,0 +1,127 @@
+#include "Allocations.h"
+
+#ifdef TRACK_ALLOCATIONS
+
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+#include <execinfo.h>
+#include <unistd.h>
+
+// glibc's own entry points, used by the wrappers below
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+}
+
+const int MAX_FRAME_SITES = 4; // Call stacks kept per frame
+const int SITE_DEPTH = 12;
+const int SKIPPED_SITE_FRAMES = 2; // noteAllocation and the malloc wrapper
+const int MAX_REPORTED_FRAMES = 50; // Later frames are only counted
+
+// Only the game thread tracks; background threads allocate as they like
+thread_local bool trackingFrame = false;
+thread_local bool insideHook = false;
+
+long long frameAllocations = 0;
+long long frameBytes = 0;
+void* frameSites[MAX_FRAME_SITES][SITE_DEPTH];
+int frameSiteDepth[MAX_FRAME_SITES];
+int frameSiteCount = 0;
+
+long long framesTracked = 0;
+long long framesAllocating = 0; // After the warm-up
+long long steadyAllocations = 0; // After the warm-up
+int framesReported = 0;
+
+static void noteAllocation(size_t size) {
+    if (!trackingFrame || insideHook) return;
+    insideHook = true;
+    frameAllocations++;
+    frameBytes += size;
+    if (frameSiteCount < MAX_FRAME_SITES) {
+        frameSiteDepth[frameSiteCount] = backtrace(frameSites[frameSiteCount], SITE_DEPTH);
+        frameSiteCount++;
+    }
+    insideHook = false;
+}
+
+extern "C" void* malloc(size_t size) {
+    noteAllocation(size);
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    noteAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* pointer, size_t size) {
+    noteAllocation(size);
+    return __libc_realloc(pointer, size);
+}
+
+extern "C" void* aligned_alloc(size_t alignment, size_t size) {
+    noteAllocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+extern "C" void* memalign(size_t alignment, size_t size) {
+    noteAllocation(size);
+    return __libc_memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void** result, size_t alignment, size_t size) {
+    noteAllocation(size);
+    void* pointer = __libc_memalign(alignment, size);
+    if (!pointer) return ENOMEM;
+    *result = pointer;
+    return 0;
+}
+
+void beginAllocationFrame() {
+    static bool unwinderLoaded = false;
+    if (!unwinderLoaded) {
+        // The first backtrace loads the unwinder, which allocates
+        void* warmup[1];
+        backtrace(warmup, 1);
+        unwinderLoaded = true;
+    }
+    frameAllocations = 0;
+    frameBytes = 0;
+    frameSiteCount = 0;
+    trackingFrame = true;
+}
+
+void endAllocationFrame() {
+    trackingFrame = false;
+    if (++framesTracked <= ALLOCATION_WARMUP_FRAMES || frameAllocations == 0) return;
+    
+    framesAllocating++;
+    steadyAllocations += frameAllocations;
+    if (framesReported == MAX_REPORTED_FRAMES) return;
+    framesReported++;
+    
+    fprintf(stderr, "allocations: frame %lld made %lld heap allocations (%lld bytes)\n",
+            framesTracked, frameAllocations, frameBytes);
+    for (int site = 0; site < frameSiteCount; ++site) {
+        fprintf(stderr, "  call site %d:\n", site + 1);
+        fflush(stderr);
+        backtrace_symbols_fd(frameSites[site] + SKIPPED_SITE_FRAMES,
+                             frameSiteDepth[site] - SKIPPED_SITE_FRAMES, STDERR_FILENO);
+    }
+    if (framesReported == MAX_REPORTED_FRAMES) {
+        fprintf(stderr, "allocations: further frames are counted but not reported\n");
+    }
+}
+
+void printAllocationSummary() {
+    fprintf(stderr, "allocations: %lld frames tracked, %lld allocating after %d warm-up frames, "
+            "%lld allocations in total\n",
+            framesTracked, framesAllocating, ALLOCATION_WARMUP_FRAMES, steadyAllocations);
+}
+
+#endif
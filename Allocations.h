@@ -0,0 +1,28 @@
+#ifndef ALLOCATIONS_H
+#define ALLOCATIONS_H
+
+// Heap allocation tracking for debug builds. Built with -DTRACK_ALLOCATIONS
+// (and -rdynamic so call sites have names), malloc and its relatives are
+// wrapped, which also catches operator new since it allocates through malloc.
+// Every allocation the game thread makes between beginAllocationFrame and
+// endAllocationFrame is counted; once past the warm-up frames, any frame that
+// allocates at all is reported on stderr with the call stacks responsible.
+// In normal builds these calls compile to nothing.
+
+#ifdef TRACK_ALLOCATIONS
+
+const int ALLOCATION_WARMUP_FRAMES = 120; // Caches filling up after startup are not reported
+
+void beginAllocationFrame();
+void endAllocationFrame();
+void printAllocationSummary();
+
+#else
+
+inline void beginAllocationFrame() {}
+inline void endAllocationFrame() {}
+inline void printAllocationSummary() {}
+
+#endif
+
+#endif
@@ -0,0 +1,45 @@
+#include "Animation.h"
+
+void sliceAnimation(Animation& animation, int left, int top, int frameSize,
+                    int frameCount, float framesPerSecond) {
+    if (frameCount > MAX_ANIMATION_FRAMES) frameCount = MAX_ANIMATION_FRAMES;
+    if (frameCount < 1) frameCount = 1;
+    animation.frameCount = frameCount;
+    animation.framesPerSecond = framesPerSecond;
+    
+    for (int frame = 0; frame < frameCount; ++frame) {
+        float u0 = static_cast<float>(left + frame * frameSize);
+        float u1 = u0 + frameSize;
+        float v0 = static_cast<float>(top);
+        float v1 = v0 + frameSize;
+        
+        sf::Vector2f* drawn = animation.corners[0][frame];
+        drawn[0] = sf::Vector2f(u0, v0);
+        drawn[1] = sf::Vector2f(u1, v0);
+        drawn[2] = sf::Vector2f(u1, v1);
+        drawn[3] = sf::Vector2f(u0, v1);
+        
+        // Mirroring swaps the left and right texture edges
+        sf::Vector2f* mirrored = animation.corners[1][frame];
+        mirrored[0] = sf::Vector2f(u1, v0);
+        mirrored[1] = sf::Vector2f(u0, v0);
+        mirrored[2] = sf::Vector2f(u0, v1);
+        mirrored[3] = sf::Vector2f(u1, v1);
+    }
+}
+
+int animationFrame(const Animation& animation, float seconds) {
+    return static_cast<int>(seconds * animation.framesPerSecond) % animation.frameCount;
+}
+
+void writeAnimationQuad(sf::Vertex* quad, const Animation& animation, int frame,
+                        bool mirrored, float x, float y, float size) {
+    const sf::Vector2f* corners = animation.corners[mirrored ? 1 : 0][frame];
+    quad[0].position = sf::Vector2f(x, y);
+    quad[1].position = sf::Vector2f(x + size, y);
+    quad[2].position = sf::Vector2f(x + size, y + size);
+    quad[3].position = sf::Vector2f(x, y + size);
+    for (int corner = 0; corner < 4; ++corner) {
+        quad[corner].texCoords = corners[corner];
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include <SFML/Graphics.hpp>
+
+// Sprite-sheet animation. A sheet is sliced once at load into a frame table
+// holding the texture corners of every frame, both as drawn and mirrored, so
+// showing a frame is a table lookup written straight into a vertex batch.
+
+const int MAX_ANIMATION_FRAMES = 16;
+
+struct Animation {
+    int frameCount;
+    float framesPerSecond;
+    // [mirrored][frame][corner], corners clockwise from the top left
+    sf::Vector2f corners[2][MAX_ANIMATION_FRAMES][4];
+};
+
+// Slices frameCount square frames laid out left to right from (left, top).
+void sliceAnimation(Animation& animation, int left, int top, int frameSize,
+                    int frameCount, float framesPerSecond);
+int animationFrame(const Animation& animation, float seconds);
+// Writes the four vertices of one frame drawn at (x, y)
+void writeAnimationQuad(sf::Vertex* quad, const Animation& animation, int frame,
+                        bool mirrored, float x, float y, float size);
+
+#endif
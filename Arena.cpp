@@ -0,0 +1,196 @@
+#include "Arena.h"
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace std;
+
+// Every chunk within ARENA_KEEP_RADIUS of the player fits at once
+const int ARENA_RESIDENT_CHUNKS = (2 * ARENA_KEEP_RADIUS + 1) * (2 * ARENA_KEEP_RADIUS + 1);
+const int PLAYER_ZONE_TOP = (GRID_ROWS - MAX_PLAYER_ROWS) * TILE_FIXED;
+
+bool arenaActive = false;
+int arenaColumns = 0;
+int arenaRows = 0;
+unsigned int arenaSeed = 1;
+long long arenaTicks = 0;
+
+// Resident chunk pool. The live chunk's slot is out of date while it is
+// loaded; it is written back before any other chunk is swapped in.
+WorldState* chunkWorlds = nullptr;
+int chunkX[ARENA_RESIDENT_CHUNKS];
+int chunkY[ARENA_RESIDENT_CHUNKS];
+bool chunkUsed[ARENA_RESIDENT_CHUNKS] = {false};
+int liveChunk = -1;
+
+static unsigned int chunkSeed(int x, int y) {
+    // Murmur3 finalizer over the arena seed and the chunk coordinates
+    unsigned int hash = arenaSeed ^ (static_cast<unsigned int>(x) * 0x9e3779b1u) ^
+                        (static_cast<unsigned int>(y) * 0x85ebca77u);
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash ? hash : 1; // xorshift must not start at zero
+}
+
+static int chunkDistance(int slot, int x, int y) {
+    return max(abs(chunkX[slot] - x), abs(chunkY[slot] - y));
+}
+
+static int findChunk(int x, int y) {
+    for (int slot = 0; slot < ARENA_RESIDENT_CHUNKS; ++slot) {
+        if (chunkUsed[slot] && chunkX[slot] == x && chunkY[slot] == y) return slot;
+    }
+    return -1;
+}
+
+static void dropFarChunks(int x, int y) {
+    for (int slot = 0; slot < ARENA_RESIDENT_CHUNKS; ++slot) {
+        if (chunkUsed[slot] && chunkDistance(slot, x, y) > ARENA_KEEP_RADIUS) {
+            chunkUsed[slot] = false;
+        }
+    }
+}
+
+// Sets up a new chunk as the live world and gives it a free slot
+static int generateChunk(int x, int y) {
+    int slot = 0;
+    while (chunkUsed[slot]) ++slot; // Callers drop far chunks first, so one is free
+    chunkUsed[slot] = true;
+    chunkX[slot] = x;
+    chunkY[slot] = y;
+    randomState = chunkSeed(x, y);
+    initializeGame();
+    return slot;
+}
+
+static void flipChunk(int dx, int dy) {
+    // The player, the score and nothing else crosses over
+    int carriedX = player[X];
+    int carriedY = player[Y];
+    int carriedScore = score;
+    projectileCount = 0;
+    saveWorldState(chunkWorlds[liveChunk]);
+
+    int x = chunkX[liveChunk] + dx;
+    int y = chunkY[liveChunk] + dy;
+    dropFarChunks(x, y);
+    int slot = findChunk(x, y);
+    if (slot == -1) {
+        GameEventSink sink = gameEventSink;
+        gameEventSink = nullptr; // A new chunk is not a new game
+        slot = generateChunk(x, y);
+        gameEventSink = sink;
+    } else {
+        loadWorldState(chunkWorlds[slot]);
+    }
+    liveChunk = slot;
+
+    // Enter from the side the player left through
+    if (dx < 0) carriedX = SCREEN_WIDTH_FIXED - TILE_FIXED;
+    if (dx > 0) carriedX = 0;
+    if (dy < 0) carriedY = SCREEN_HEIGHT_FIXED - TILE_FIXED;
+    if (dy > 0) carriedY = PLAYER_ZONE_TOP;
+    player[X] = carriedX;
+    player[Y] = carriedY;
+    score = carriedScore;
+    updateWorldHash();
+}
+
+static void stepBackgroundChunks() {
+    int x = chunkX[liveChunk];
+    int y = chunkY[liveChunk];
+    bool liveSaved = false;
+    GameEventSink sink = gameEventSink;
+    gameEventSink = nullptr; // Only the live chunk reports events
+    for (int slot = 0; slot < ARENA_RESIDENT_CHUNKS; ++slot) {
+        if (!chunkUsed[slot] || slot == liveChunk || chunkDistance(slot, x, y) > ARENA_ACTIVE_RADIUS) continue;
+        if (!liveSaved) {
+            saveWorldState(chunkWorlds[liveChunk]);
+            liveSaved = true;
+        }
+        loadWorldState(chunkWorlds[slot]);
+        updateUnwatchedWorld();
+        saveWorldState(chunkWorlds[slot]);
+    }
+    if (liveSaved) {
+        loadWorldState(chunkWorlds[liveChunk]);
+    }
+    gameEventSink = sink;
+}
+
+bool startArena(int columns, int rows) {
+    if (columns < 1 || rows < 1 || columns > ARENA_MAX_SIDE || rows > ARENA_MAX_SIDE) return false;
+    arenaColumns = columns;
+    arenaRows = rows;
+    chunkWorlds = new WorldState[ARENA_RESIDENT_CHUNKS];
+    memset(chunkUsed, 0, sizeof(chunkUsed));
+    liveChunk = -1;
+    arenaActive = true;
+    clearedFieldWins = false; // updateArena reports the cleared chunk instead
+
+    return true;
+}
+
+void stopArena() {
+    if (!arenaActive) return;
+    delete[] chunkWorlds;
+    chunkWorlds = nullptr;
+    arenaActive = false;
+    clearedFieldWins = true;
+}
+
+bool isArenaActive() {
+    return arenaActive;
+}
+
+void resetArena() {
+    arenaSeed = randomState;
+    arenaTicks = 0;
+    memset(chunkUsed, 0, sizeof(chunkUsed));
+    liveChunk = generateChunk(arenaColumns / 2, arenaRows - 1);
+}
+
+int updateArena(const bool input[], int outcome) {
+    if (outcome == TICK_PLAYER_DIED) return outcome;
+    if (outcome == TICK_PLAYER_WON) {
+        playerWon = false; // The chunk stays cleared and play goes on
+        outcome = TICK_RUNNING;
+        emitGameEvent(EVENT_CHUNK_CLEARED, score, chunkX[liveChunk], chunkY[liveChunk]);
+    }
+
+    int x = chunkX[liveChunk];
+    int y = chunkY[liveChunk];
+    if (input[INPUT_LEFT] && player[X] <= 0 && x > 0) {
+        flipChunk(-1, 0);
+    } else if (input[INPUT_RIGHT] && player[X] >= SCREEN_WIDTH_FIXED - TILE_FIXED && x < arenaColumns - 1) {
+        flipChunk(1, 0);
+    } else if (input[INPUT_UP] && player[Y] <= PLAYER_ZONE_TOP && y > 0) {
+        flipChunk(0, -1);
+    } else if (input[INPUT_DOWN] && player[Y] >= SCREEN_HEIGHT_FIXED - TILE_FIXED && y < arenaRows - 1) {
+        flipChunk(0, 1);
+    }
+
+    if (++arenaTicks % ARENA_COARSE_TICKS == 0) {
+        stepBackgroundChunks();
+    }
+    return outcome;
+}
+
+int arenaChunkX() {
+    return liveChunk == -1 ? 0 : chunkX[liveChunk];
+}
+
+int arenaChunkY() {
+    return liveChunk == -1 ? 0 : chunkY[liveChunk];
+}
+
+int arenaResidentChunks() {
+    int count = 0;
+    for (int slot = 0; slot < ARENA_RESIDENT_CHUNKS; ++slot) {
+        if (chunkUsed[slot]) count++;
+    }
+    return count;
+}
@@ -0,0 +1,40 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "Simulation.h"
+
+// Arena mode: a playfield many screens wide and tall, stored as screen-sized
+// chunks. Each chunk is a whole world, generated the first time it is needed
+// from the arena seed and its coordinates. The chunk the player is in is the
+// live world: it runs at the full tick rate and is the only one drawn.
+// Resident chunks within ARENA_ACTIVE_RADIUS of it move their centipedes one
+// step every ARENA_COARSE_TICKS ticks; the rest of the resident ones are
+// frozen. Chunks further than ARENA_KEEP_RADIUS away are dropped and come back
+// freshly generated, so memory and tick cost depend on the resident area,
+// never on the size of the arena.
+//
+// Pushing against the edge of the screen flips to the neighbouring chunk:
+// left and right from the sides, up from the top of the player zone and down
+// from the bottom row.
+
+const int ARENA_ACTIVE_RADIUS = 1; // Chunks, counted along either axis
+const int ARENA_KEEP_RADIUS = 2;
+const int ARENA_COARSE_TICKS = 8;
+const int ARENA_MAX_SIDE = 4096; // Chunks along one side of the arena
+
+bool startArena(int columns, int rows); // Allocates the resident chunk pool
+void stopArena();
+bool isArenaActive();
+// Starts a new arena game in the bottom middle chunk, seeded from randomState
+void resetArena();
+// Call after updateGame with the same input and its outcome. Moves the player
+// to a neighbouring chunk and steps the background chunks. A cleared chunk
+// does not end an arena game, so TICK_PLAYER_WON comes back as TICK_RUNNING
+// and is reported as EVENT_CHUNK_CLEARED; updateGame sends no EVENT_PLAYER_WON
+// while the arena is started.
+int updateArena(const bool input[], int outcome);
+int arenaChunkX();
+int arenaChunkY();
+int arenaResidentChunks();
+
+#endif
@@ -0,0 +1,130 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <thread>
+#include "Simulation.h"
+#include "Replay.h"
+#include "VectorEnv.h"
+
+using namespace std;
+
+// Headless benchmark built without SFML. It runs a fixed seeded workload:
+// idle games, autopilot games and a VectorEnv batch. --train runs the replay
+// corpus and then the benchmark, which is the workload profile-guided builds
+// are trained on. The checks ctest runs live in Tests.cpp.
+
+const int VECTOR_ENVS = 64;
+const int VECTOR_STEPS = 2000;
+
+struct TickTimes {
+    vector<long long> nanos;
+    int games = 0;
+};
+
+static void reportTicks(const char* name, TickTimes& times) {
+    sort(times.nanos.begin(), times.nanos.end());
+    long long total = 0;
+    for (size_t i = 0; i < times.nanos.size(); ++i) total += times.nanos[i];
+    size_t count = times.nanos.size();
+    cout << name << ": " << count << " ticks in " << times.games << " games, avg "
+         << (count ? total / static_cast<long long>(count) : 0) << " ns, p50 "
+         << (count ? times.nanos[count / 2] : 0) << " ns, p99 "
+         << (count ? times.nanos[count * 99 / 100] : 0) << " ns, max "
+         << (count ? times.nanos[count - 1] : 0) << " ns" << endl;
+}
+
+// Times updateGame alone; the autopilot's planning is timed separately
+static void runGames(const char* name, long long ticks, unsigned int seed, bool autopilot) {
+    randomState = seed;
+    initializeGame();
+    TickTimes simulation, planning;
+    simulation.nanos.reserve(ticks);
+    if (autopilot) planning.nanos.reserve(ticks);
+    bool input[NUM_INPUTS] = {false};
+    for (long long tick = 0; tick < ticks; ++tick) {
+        chrono::steady_clock::time_point planStart = chrono::steady_clock::now();
+        if (autopilot) chooseAutopilotInput(input);
+        chrono::steady_clock::time_point simStart = chrono::steady_clock::now();
+        int outcome = updateGame(input);
+        chrono::steady_clock::time_point simEnd = chrono::steady_clock::now();
+        simulation.nanos.push_back(chrono::duration_cast<chrono::nanoseconds>(simEnd - simStart).count());
+        if (autopilot) planning.nanos.push_back(chrono::duration_cast<chrono::nanoseconds>(simStart - planStart).count());
+        if (outcome != TICK_RUNNING) {
+            simulation.games++;
+            initializeGame();
+        }
+    }
+    planning.games = simulation.games;
+    reportTicks(name, simulation);
+    if (autopilot) reportTicks("autopilot planning", planning);
+}
+
+static void runVectorEnv(int threads, unsigned int seed) {
+    VectorEnv* env = createVectorEnv(VECTOR_ENVS, threads, seed);
+    vector<unsigned char> observations(VECTOR_ENVS * OBSERVATION_SIZE);
+    vector<unsigned char> actions(VECTOR_ENVS), dones(VECTOR_ENVS);
+    vector<int> scores(VECTOR_ENVS);
+    resetVectorEnv(env, observations.data());
+
+    // Actions held for a few steps, the way a policy with frame skip acts
+    unsigned int actionRandom = seed;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int step = 0; step < VECTOR_STEPS; ++step) {
+        if (step % 8 == 0) {
+            for (int i = 0; i < VECTOR_ENVS; ++i) {
+                actionRandom ^= actionRandom << 13;
+                actionRandom ^= actionRandom >> 17;
+                actionRandom ^= actionRandom << 5;
+                actions[i] = actionRandom & ((1 << NUM_INPUTS) - 1);
+            }
+        }
+        stepVectorEnv(env, actions.data(), observations.data(), scores.data(), dones.data());
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    destroyVectorEnv(env);
+    cout << "vector env: " << VECTOR_ENVS << " worlds on " << threads << " threads, "
+         << static_cast<long long>(VECTOR_ENVS * VECTOR_STEPS / seconds) << " world steps/s" << endl;
+}
+
+static void runBenchmark(long long ticks, unsigned int seed, int threads) {
+    runGames("idle", ticks, seed, false);
+    runGames("autopilot", ticks, seed, true);
+    runVectorEnv(threads, seed);
+}
+
+int main(int argc, char* argv[]) {
+    long long ticks = 0; // 0 = the mode's default
+    unsigned int seed = 1;
+    int threads = max(1, static_cast<int>(thread::hardware_concurrency()));
+    const char* trainPath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            ticks = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--budget-us") == 0 && i + 1 < argc) {
+            autopilotBudgetMicros = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--train") == 0 && i + 1 < argc) {
+            trainPath = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--ticks N] [--seed N] [--threads N] [--budget-us N]"
+                      << " [--train PATH]"
+                      << std::endl;
+            return -1;
+        }
+    }
+    if (seed == 0) seed = 1; // xorshift must not start at zero
+
+    if (trainPath && !verifyReplays(trainPath)) {
+        return 1; // A profile of diverging games would train the wrong paths
+    }
+    runBenchmark(ticks ? ticks : 60 * TICKS_PER_SECOND, seed, threads);
+    return 0;
+}
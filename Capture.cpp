@@ -0,0 +1,254 @@
+#include "Capture.h"
+#include "Metrics.h"
+#define GL_GLEXT_PROTOTYPES
+#include <SFML/OpenGL.hpp>
+#include <GL/glext.h>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+using namespace std;
+
+const int CAPTURE_READBACKS = 3; // A readback is collected three captures after it was issued
+const int ENCODER_IDLE_MS = 2;
+
+// A CPU-side buffer is owned by the game thread while free and by the
+// encoder while ready, so the state flag is the only thing they share
+const int BUFFER_FREE = 0;
+const int BUFFER_READY = 1;
+
+struct CaptureBuffer {
+    vector<sf::Uint8> pixels; // Bottom row first, as OpenGL reads them
+    int width = 0;
+    int height = 0;
+    long long frame = 0; // Index in the recording
+    atomic<int> state{BUFFER_FREE};
+};
+
+CaptureBuffer captureBuffers[CAPTURE_BUFFERS];
+
+// Game thread side
+bool capturing = false;
+int captureFramesPerSecond = 60;
+chrono::steady_clock::time_point captureStart;
+long long lastSampledFrame = -1;
+GLuint readbackBuffers[CAPTURE_READBACKS];
+long long readbackBytes[CAPTURE_READBACKS] = {0};
+bool readbackPending[CAPTURE_READBACKS] = {false};
+int readbackWidth[CAPTURE_READBACKS];
+int readbackHeight[CAPTURE_READBACKS];
+long long readbackFrame[CAPTURE_READBACKS];
+int nextReadback = 0;
+
+// Encoder side
+thread captureEncoder;
+atomic<bool> captureStopping(false);
+string capturePrefix;
+int captureFormat = CAPTURE_RAW;
+ofstream rawFile;
+int rawWidth = 0, rawHeight = 0;
+int rawSegment = 0;
+vector<sf::Uint8> encodedFrame; // Top row first, opaque
+vector<sf::Uint8> previousFrame;
+string previousPngPath;
+long long lastWrittenFrame = -1;
+
+// Moves a finished readback into a free CPU buffer, or drops it
+static void collectReadback(int slot) {
+    readbackPending[slot] = false;
+    CaptureBuffer* target = nullptr;
+    for (int i = 0; i < CAPTURE_BUFFERS; ++i) {
+        if (captureBuffers[i].state.load(memory_order_acquire) == BUFFER_FREE) {
+            target = &captureBuffers[i];
+            break;
+        }
+    }
+    if (!target) {
+        addMetric(METRIC_CAPTURE_DROPPED, 1);
+        return;
+    }
+    
+    size_t bytes = static_cast<size_t>(readbackWidth[slot]) * readbackHeight[slot] * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readbackBuffers[slot]);
+    const void* mapped = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (mapped) {
+        target->pixels.resize(bytes); // Only allocates when the capture size grows
+        memcpy(target->pixels.data(), mapped, bytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!mapped) {
+        addMetric(METRIC_CAPTURE_DROPPED, 1);
+        return;
+    }
+    target->width = readbackWidth[slot];
+    target->height = readbackHeight[slot];
+    target->frame = readbackFrame[slot];
+    target->state.store(BUFFER_READY, memory_order_release);
+    addMetric(METRIC_CAPTURED_FRAMES, 1);
+}
+
+static bool openRawSegment(int width, int height) {
+    if (rawFile.is_open()) rawFile.close();
+    // ffmpeg -f rawvideo -pix_fmt rgba -s WxH -r FPS -i FILE reads these directly
+    string path = capturePrefix + "-" + to_string(rawSegment++) + "-" + to_string(width) + "x" +
+                  to_string(height) + ".rgba";
+    rawFile.open(path, ios::binary);
+    if (!rawFile.is_open()) {
+        std::cerr << "Failed to open capture file " << path << std::endl;
+        return false;
+    }
+    rawWidth = width;
+    rawHeight = height;
+    return true;
+}
+
+static void writeFrame(const vector<sf::Uint8>& frame, int width, int height, long long index) {
+    if (captureFormat == CAPTURE_RAW) {
+        if ((width != rawWidth || height != rawHeight || !rawFile.is_open()) && !openRawSegment(width, height)) {
+            return;
+        }
+        rawFile.write(reinterpret_cast<const char*>(frame.data()), frame.size());
+        return;
+    }
+    
+    char name[32];
+    snprintf(name, sizeof(name), "-%06lld.png", index);
+    string path = capturePrefix + name;
+    sf::Image image;
+    image.create(width, height, frame.data());
+    if (!image.saveToFile(path)) {
+        std::cerr << "Failed to write capture frame " << path << std::endl;
+    }
+    previousPngPath = path;
+}
+
+static void encodeBuffer(CaptureBuffer& buffer) {
+    int width = buffer.width, height = buffer.height;
+    size_t rowBytes = static_cast<size_t>(width) * 4;
+    encodedFrame.resize(rowBytes * height);
+    for (int row = 0; row < height; ++row) {
+        const sf::Uint8* source = &buffer.pixels[(height - 1 - row) * rowBytes];
+        sf::Uint8* destination = &encodedFrame[row * rowBytes];
+        memcpy(destination, source, rowBytes);
+        for (size_t alpha = 3; alpha < rowBytes; alpha += 4) {
+            destination[alpha] = 255; // The back buffer's alpha is not meant to be seen
+        }
+    }
+    
+    // Frames the game did not draw (idle screens, drops) repeat the last one,
+    // for at most a second, so the recording keeps real time
+    if (lastWrittenFrame >= 0 && !previousFrame.empty()) {
+        long long gap = min<long long>(buffer.frame - lastWrittenFrame - 1, captureFramesPerSecond);
+        for (long long i = 1; i <= gap; ++i) {
+            if (captureFormat == CAPTURE_RAW) {
+                if (previousFrame.size() == encodedFrame.size()) writeFrame(previousFrame, width, height, 0);
+            } else {
+                char name[32];
+                snprintf(name, sizeof(name), "-%06lld.png", lastWrittenFrame + i);
+                error_code error;
+                filesystem::copy_file(previousPngPath, capturePrefix + name,
+                                      filesystem::copy_options::overwrite_existing, error);
+            }
+        }
+    }
+    
+    writeFrame(encodedFrame, width, height, buffer.frame);
+    lastWrittenFrame = buffer.frame;
+    previousFrame.swap(encodedFrame);
+}
+
+static void encoderLoop() {
+    while (true) {
+        // Oldest ready frame first
+        CaptureBuffer* next = nullptr;
+        for (int i = 0; i < CAPTURE_BUFFERS; ++i) {
+            CaptureBuffer& buffer = captureBuffers[i];
+            if (buffer.state.load(memory_order_acquire) == BUFFER_READY && (!next || buffer.frame < next->frame)) {
+                next = &buffer;
+            }
+        }
+        if (next) {
+            encodeBuffer(*next);
+            next->state.store(BUFFER_FREE, memory_order_release);
+            continue;
+        }
+        if (captureStopping.load()) break;
+        this_thread::sleep_for(chrono::milliseconds(ENCODER_IDLE_MS));
+    }
+    if (rawFile.is_open()) rawFile.close();
+}
+
+bool startCapture(const char* pathPrefix, int format, int framesPerSecond) {
+    if (framesPerSecond <= 0) {
+        std::cerr << "Capture rate must be positive" << std::endl;
+        return false;
+    }
+    capturePrefix = pathPrefix;
+    captureFormat = format;
+    captureFramesPerSecond = framesPerSecond;
+    glGenBuffers(CAPTURE_READBACKS, readbackBuffers);
+    
+    captureStart = chrono::steady_clock::now();
+    capturing = true;
+    captureStopping.store(false);
+    captureEncoder = thread(encoderLoop);
+    return true;
+}
+
+void captureFrame(sf::RenderWindow& window, const sf::IntRect& region) {
+    if (!capturing) return;
+    
+    // Sample at the capture rate: skip frames until the next recording frame is due
+    long long elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - captureStart).count();
+    long long frame = elapsed * captureFramesPerSecond / 1000000;
+    if (frame <= lastSampledFrame) return;
+    lastSampledFrame = frame;
+    
+    // The oldest readback has had a few frames to finish, so mapping it does not stall
+    int slot = nextReadback;
+    nextReadback = (nextReadback + 1) % CAPTURE_READBACKS;
+    if (readbackPending[slot]) collectReadback(slot);
+    
+    int windowHeight = static_cast<int>(window.getSize().y);
+    int left = max(region.left, 0);
+    int top = max(region.top, 0);
+    int width = min(region.width, static_cast<int>(window.getSize().x) - left);
+    int height = min(region.height, windowHeight - top);
+    if (width <= 0 || height <= 0) return;
+    
+    long long bytes = static_cast<long long>(width) * height * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readbackBuffers[slot]);
+    if (readbackBytes[slot] < bytes) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+        readbackBytes[slot] = bytes;
+    }
+    // OpenGL counts rows from the bottom; with a bound buffer this only queues the copy
+    glReadPixels(left, windowHeight - top - height, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    
+    readbackPending[slot] = true;
+    readbackWidth[slot] = width;
+    readbackHeight[slot] = height;
+    readbackFrame[slot] = frame;
+}
+
+void stopCapture() {
+    if (!capturing) return;
+    capturing = false;
+    // Readbacks still on the GPU are given up: the window, and with it the
+    // OpenGL context, may already be gone
+    captureStopping.store(true);
+    captureEncoder.join();
+}
+
+bool isCapturing() {
+    return capturing;
+}
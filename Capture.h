@@ -0,0 +1,26 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <SFML/Graphics.hpp>
+
+// Gameplay recording. Each captured frame is read back from the window into
+// a pixel buffer object, so the GPU copies it while the game carries on; two
+// frames later it is mapped and copied into one of a few CPU-side buffers
+// that a background thread encodes to disk. When every buffer is still
+// waiting for the encoder the frame is dropped; the game never waits.
+// Frames are sampled at a fixed rate from real time, so the recording plays
+// back at the right speed whatever the game's frame rate.
+
+const int CAPTURE_RAW = 0; // Raw RGBA frames, one file per capture size
+const int CAPTURE_PNG = 1; // One numbered PNG file per frame
+
+const int CAPTURE_BUFFERS = 4; // CPU-side frames queued for the encoder at most
+
+bool startCapture(const char* pathPrefix, int format, int framesPerSecond);
+// Call with the finished frame still in the back buffer, before display().
+// The region is in window pixels, top-left origin.
+void captureFrame(sf::RenderWindow& window, const sf::IntRect& region);
+void stopCapture(); // Waits for queued frames to be written
+bool isCapturing();
+
+#endif
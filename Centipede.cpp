@@ -4,50 +4,33 @@
 #include <SFML/System/Clock.hpp>
 #include <fstream>
 #include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <ctime>
+#include <chrono>
+#include <algorithm>
+#include <thread>
+#include "Simulation.h"
+#include "Replay.h"
+#include "Effects.h"
+#include "Animation.h"
+#include "Display.h"
+#include "Telemetry.h"
+#include "Metrics.h"
+#include "Watchdog.h"
+#include "Allocations.h"
+#include "Capture.h"
+#include "Arena.h"
+#include "Tuning.h"
+#include "Netplay.h"
+#include "Spectator.h"
 
 using namespace std;
 
-// Game constants with improved naming
-const int SCREEN_WIDTH = 960;
-const int SCREEN_HEIGHT = 960;
-const int TILE_SIZE = 32;
-const int GRID_COLS = SCREEN_WIDTH / TILE_SIZE;
-const int GRID_ROWS = SCREEN_HEIGHT / TILE_SIZE;
-const int MAX_PLAYER_ROWS = 5; // Bottom 5 rows
-const int NUM_MUSHROOMS = 30;
-const int CENTIPEDE_LENGTH = 12;
-const float BULLET_SPEED = 10.0f;
-const float PLAYER_SPEED = 4.0f;
-
-// Game grid
-const int MAX_GROUPS = 10; // Maximum number of centipede groups
-int centipedeGroup[CENTIPEDE_LENGTH] = {0}; // Tracks which group each segment belongs to
-bool groupMoveLeft[MAX_GROUPS] = {true}; // Movement direction for each group
-int groupCount = 1; // Number of active centipede groups
-
-int gameGrid[GRID_COLS][GRID_ROWS] = {};
-
-// Constants for array indices
-const int X = 0;
-const int Y = 1;
-const int EXISTS = 2;
-const int DAMAGE = 3;  // For mushrooms
-const int IS_POISONOUS = 4;
-
-// Game objects
-int mushroomGrid[NUM_MUSHROOMS][5];
-int centipedeGrid[CENTIPEDE_LENGTH][3];
-float bullet[3] = {};
-float player[2] = {};
-bool groupReentering[MAX_GROUPS] = {false}; // Tracks if group is re-entering
-float reentryOffset[CENTIPEDE_LENGTH] = {0}; // X-offset for each segment during re-entry
-
 // Game state
-int score = 0;
 bool gameOver = false;
 bool gamePaused = false;
-bool moveLeft = true;  // Direction for centipede
-bool playerWon = false; // Tracks win condition
 
 const int MENU_STATE = 0;
 const int GAME_STATE = 1;
@@ -67,61 +50,324 @@ int selectedMenuItem = MENU_PLAY;
 const int MAX_HIGH_SCORES = 5;
 int highScores[MAX_HIGH_SCORES] = {0};
 const char* HIGH_SCORE_FILE = "highscores.txt";
-bool groupInPlayerArea[MAX_GROUPS] = {false}; // Tracks if group is in player area
-sf::Clock headSpawnClock; // Timer for spawning new heads
-const float HEAD_SPAWN_INTERVAL = 5.0f; // Seconds between head spawns
+
+// Screen texts are laid out once at startup; frames only recolor and scale them
+const int TEXT_MENU_TITLE = 0;
+const int TEXT_MENU_WIN = 1;
+const int TEXT_MENU_PLAY = 2;
+const int TEXT_MENU_HIGH_SCORES = 3;
+const int TEXT_MENU_EXIT = 4;
+const int TEXT_GAME_OVER_TITLE = 5;
+const int TEXT_GAME_OVER_MAIN_MENU = 6;
+const int TEXT_GAME_OVER_RESTART = 7;
+const int TEXT_GAME_OVER_LEADERBOARD = 8;
+const int TEXT_HIGH_SCORES_TITLE = 9;
+const int TEXT_HIGH_SCORES_BACK = 10;
+const int TEXT_PAUSED = 11;
+const int TEXT_WAITING = 12;
+const int TEXT_HIGH_SCORE_LINES = 13; // One per high score entry
+const int NUM_SCREEN_TEXTS = TEXT_HIGH_SCORE_LINES + MAX_HIGH_SCORES;
+sf::Text screenTexts[NUM_SCREEN_TEXTS];
+
+// The score is built from the font's glyphs into a fixed vertex batch, so a
+// changing score never allocates the way sf::Text::setString does
+const unsigned int SCORE_CHARACTER_SIZE = 31; // Increased by 30% from 24
+const int MAX_SCORE_CHARS = 24;
+const char* SCORE_LABEL = "Score: ";
+sf::Vertex scoreVertices[MAX_SCORE_CHARS * 4];
+
+// Input source
+bool playerInput[NUM_INPUTS] = {false};
+bool autopilotEnabled = false;
+
+// Co-op session, while one is open
+NetSession* netSession = nullptr;
+const sf::Color PARTNER_TINT(120, 200, 255);
+
+// Centipede drawing: both walk sheets share one atlas and one vertex batch
+const float WALK_FRAMES_PER_SECOND = 12.0f;
+sf::Texture centipedeAtlas;
+Animation bodyWalk, headWalk;
+float groupWalkClock[MAX_GROUPS] = {0.0f}; // Seconds of walk animation played per group
+sf::Vertex centipedeVertices[CENTIPEDE_LENGTH * 4];
+
+// Every shot in flight is one quad of a single batch
+sf::Vertex projectileVertices[MAX_PROJECTILES * 4];
+
+// What was alive before the last tick, to place effects where things died
+bool segmentWasAlive[CENTIPEDE_LENGTH] = {false};
+bool mushroomWasAlive[NUM_MUSHROOMS] = {false};
+
+// Headless run settings
+const int HEADLESS_REPORT_TICKS = 60 * TICKS_PER_SECOND; // One report per simulated minute
+
+// Windowed runs simulate in fixed ticks to keep up with real time
+const long long MICROS_PER_TICK = 1000000 / TICKS_PER_SECOND;
+const int MAX_TICKS_PER_FRAME = 8; // After a longer stall the lost time is dropped
+
+// Screens that only change on input are redrawn on demand
+const int ANIMATION_FRAME_MS = 16; // Wake-up interval while effects still play on them
+const int UNFOCUSED_FRAME_MS = 50; // Frame interval while another window has focus
 
 // Function declarations
 bool loadResources(sf::Texture& backgroundTexture, sf::Texture& mushroomTexture,
-                  sf::Texture& poisonMushroomTexture, sf::Texture& centipedeTexture,
-                  sf::Texture& headTexture, sf::Texture& playerTexture, sf::Texture& bulletTexture,
-                  sf::Font& font, sf::Music& bgMusic);
-void drawMushrooms(sf::RenderWindow& window, sf::Sprite& mushroomSprite, 
+                  sf::Texture& poisonMushroomTexture, sf::Texture& playerTexture,
+                  sf::Texture& bulletTexture, sf::Font& font, sf::Music& bgMusic);
+bool loadCentipedeSheets();
+void drawMushrooms(sf::RenderTarget& target, sf::Sprite& mushroomSprite, 
                   sf::Sprite& poisonMushroomSprite);
 bool isSpaceKeyPressed(sf::RenderWindow& window);
-void initializeGame();
-void initializeMushrooms();
-void initializeCentipede();
-void drawCentipede(sf::RenderWindow& window, sf::Sprite& centipedeSprite, sf::Sprite& headSprite);
-void moveCentipede(float deltaTime);
-void checkCentipedeMushroomCollisions();
-bool checkCollision(float x1, float y1, int w1, int h1, float x2, float y2, int w2, int h2);
-void checkBulletMushroomCollisions();
-bool checkPlayerCentipedeCollision();
-void moveBullet(float deltaTime);
-void drawBullet(sf::RenderWindow& window, sf::Sprite& bulletSprite);
-void drawPlayer(sf::RenderWindow& window, sf::Sprite& playerSprite);
-void checkBulletCentipedeCollisions();
-void handleInput(float deltaTime, sf::RenderWindow& window);
+void advanceWalkClocks(float seconds);
+void drawCentipede(sf::RenderTarget& target);
+void drawProjectiles(sf::RenderTarget& target, const sf::Texture& bulletTexture);
+void drawPlayer(sf::RenderTarget& target, sf::Sprite& playerSprite);
+void readKeyboardInput(sf::RenderWindow& window, bool input[]);
+bool isIdleScreen();
+void rememberLiveObjects();
+void recordTickMetrics(long long tickNanos, unsigned long long collisionPairs, int outcome);
+void updateWorldGauges();
+void spawnKillEffects(int outcome);
+int runHeadless(long long maxTicks);
+void runSpectatorLoop(sf::RenderWindow& window, sf::Sprite& backgroundSprite);
 void resetGame();
-void renderScore(sf::RenderWindow& window, sf::Text& scoreText);
-void drawMenu(sf::RenderWindow& window, sf::Font& font);
+void buildScreenTexts(sf::Font& font);
+void layoutHighScoreTexts();
+void renderScore(sf::RenderTarget& target, sf::Font& font);
+void drawMenu(sf::RenderTarget& target);
 void handleMenuInput(sf::Event& event, sf::RenderWindow& window);
 void saveHighScores();
 void loadHighScores();
 void updateHighScores(int newScore);
-void drawHighScores(sf::RenderWindow& window, sf::Font& font);
-void splitCentipede(int hitSegmentIndex);
-void spawnNewHead();
-void drawGameOverMenu(sf::RenderWindow& window, sf::Font& font);
+void drawHighScores(sf::RenderTarget& target);
+void drawGameOverMenu(sf::RenderTarget& target);
 
-int main() {
-    srand(static_cast<unsigned int>(time(nullptr)));
+int main(int argc, char* argv[]) {
+    randomState = static_cast<unsigned int>(time(nullptr));
+    bool headless = false;
+    long long maxTicks = 0; // 0 = run until stopped
+    const char* recordPath = nullptr;
+    const char* verifyPath = nullptr;
+    int windowSize = 640; // Window side in pixels
+    bool fullscreen = false;
+    int internalSize = 0; // 0 = draw straight to the window
+    const char* telemetryPath = nullptr;
+    int telemetryFormat = TELEMETRY_JSONL;
+    int metricsPort = 0; // 0 = no scrape endpoint
+    const char* metricsPath = nullptr;
+    const char* flightDirectory = "."; // Where flight records are dumped
+    int frameBudgetMicros = 250000;
+    int tickBudgetMicros = 5000;
+    int hangSeconds = 5;
+    const char* capturePrefix = nullptr;
+    int captureFormat = CAPTURE_RAW;
+    int captureFramesPerSecond = 60;
+    int arenaColumns = 0, arenaRows = 0; // 0 = the classic single screen
+    const char* tuningPath = nullptr;
+    int hostPort = 0; // 0 = no co-op
+    const char* joinAddress = nullptr;
+    int netLatencyMillis = 0;
+    int netLossPercent = 0;
+    bool netplayTest = false;
+    int spectateGames = 0; // 0 = play one game
+    int spectateThreads = static_cast<int>(std::thread::hardware_concurrency());
+    
+    // Command line options
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (strcmp(argv[i], "--autopilot") == 0) {
+            autopilotEnabled = true;
+        } else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            maxTicks = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            randomState = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--budget-us") == 0 && i + 1 < argc) {
+            autopilotBudgetMicros = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (strcmp(argv[i], "--verify-replays") == 0 && i + 1 < argc) {
+            verifyPath = argv[++i];
+        } else if (strcmp(argv[i], "--window-size") == 0 && i + 1 < argc) {
+            windowSize = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fullscreen") == 0) {
+            fullscreen = true;
+        } else if (strcmp(argv[i], "--internal-res") == 0 && i + 1 < argc) {
+            internalSize = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc) {
+            telemetryPath = argv[++i];
+        } else if (strcmp(argv[i], "--telemetry-binary") == 0) {
+            telemetryFormat = TELEMETRY_BINARY;
+        } else if (strcmp(argv[i], "--metrics-port") == 0 && i + 1 < argc) {
+            metricsPort = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--metrics-file") == 0 && i + 1 < argc) {
+            metricsPath = argv[++i];
+        } else if (strcmp(argv[i], "--flight-dir") == 0 && i + 1 < argc) {
+            flightDirectory = argv[++i];
+        } else if (strcmp(argv[i], "--frame-budget-ms") == 0 && i + 1 < argc) {
+            frameBudgetMicros = atoi(argv[++i]) * 1000;
+        } else if (strcmp(argv[i], "--tick-budget-us") == 0 && i + 1 < argc) {
+            tickBudgetMicros = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--hang-seconds") == 0 && i + 1 < argc) {
+            hangSeconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+            capturePrefix = argv[++i];
+        } else if (strcmp(argv[i], "--capture-png") == 0) {
+            captureFormat = CAPTURE_PNG;
+        } else if (strcmp(argv[i], "--capture-fps") == 0 && i + 1 < argc) {
+            captureFramesPerSecond = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--field") == 0 && i + 1 < argc) {
+            mushroomFieldStrategy = fieldStrategyFromName(argv[++i]);
+            if (mushroomFieldStrategy < 0) {
+                std::cerr << "Unknown mushroom field " << argv[i] << " (shuffle, spaced or rows)" << std::endl;
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--tuning") == 0 && i + 1 < argc) {
+            tuningPath = argv[++i];
+        } else if (strcmp(argv[i], "--arena") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &arenaColumns, &arenaRows) != 2) {
+                std::cerr << "Arena size must look like 8x8, got " << argv[i] << std::endl;
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--host") == 0 && i + 1 < argc) {
+            hostPort = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--join") == 0 && i + 1 < argc) {
+            joinAddress = argv[++i];
+        } else if (strcmp(argv[i], "--net-latency-ms") == 0 && i + 1 < argc) {
+            netLatencyMillis = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--net-loss") == 0 && i + 1 < argc) {
+            netLossPercent = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--netplay-test") == 0) {
+            netplayTest = true;
+        } else if (strcmp(argv[i], "--spectate") == 0 && i + 1 < argc) {
+            spectateGames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--spectate-threads") == 0 && i + 1 < argc) {
+            spectateThreads = atoi(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--headless] [--autopilot] [--ticks N] [--seed N] [--budget-us N]"
+                      << " [--record FILE] [--verify-replays PATH]"
+                      << " [--window-size N] [--fullscreen] [--internal-res N]"
+                      << " [--telemetry FILE] [--telemetry-binary]"
+                      << " [--metrics-port N] [--metrics-file FILE]"
+                      << " [--flight-dir DIR] [--frame-budget-ms N] [--tick-budget-us N] [--hang-seconds N]"
+                      << " [--capture PREFIX] [--capture-png] [--capture-fps N]"
+                      << " [--field shuffle|spaced|rows] [--arena COLSxROWS] [--tuning FILE]"
+                      << " [--host PORT | --join HOST:PORT] [--net-latency-ms N] [--net-loss N] [--netplay-test]"
+                      << " [--spectate N] [--spectate-threads N]" << std::endl;
+            return -1;
+        }
+    }
+    if (randomState == 0) randomState = 1; // xorshift must not start at zero
+    
+    if (verifyPath) {
+        return verifyReplays(verifyPath) ? 0 : 1;
+    }
+    if (netplayTest) {
+        return runNetplayLoopbackTest(maxTicks ? maxTicks : 10 * TICKS_PER_SECOND, randomState,
+                                      netLatencyMillis, netLossPercent) ? 0 : 1;
+    }
+    if (hostPort || joinAddress) {
+        // Both peers must run the same plain game
+        if (hostPort && joinAddress) {
+            std::cerr << "Use either --host or --join, not both" << std::endl;
+            return -1;
+        }
+        if (headless || recordPath || autopilotEnabled || tuningPath || arenaColumns || arenaRows) {
+            std::cerr << "Co-op cannot be used with --headless, --record, --autopilot, --tuning or --arena" << std::endl;
+            return -1;
+        }
+    }
+    if (spectateGames) {
+        // The tiles are plain autopilot games stepped off the main thread
+        if (spectateGames < 1 || spectateGames > MAX_SPECTATOR_GAMES) {
+            std::cerr << "Spectate between 1 and " << MAX_SPECTATOR_GAMES << " games" << std::endl;
+            return -1;
+        }
+        if (headless || recordPath || tuningPath || arenaColumns || arenaRows || hostPort || joinAddress) {
+            std::cerr << "--spectate cannot be used with --headless, --record, --tuning, --arena or co-op" << std::endl;
+            return -1;
+        }
+    }
+    if (arenaColumns || arenaRows) {
+        if (recordPath) {
+            std::cerr << "Replays hold single-screen games; --arena cannot be used with --record" << std::endl;
+            return -1;
+        }
+        if (!startArena(arenaColumns, arenaRows)) {
+            std::cerr << "Arena sides must be between 1 and " << ARENA_MAX_SIDE << " screens" << std::endl;
+            return -1;
+        }
+    }
+    if (tuningPath && recordPath) {
+        std::cerr << "Replays hold games with the default tuning; --tuning cannot be used with --record" << std::endl;
+        return -1;
+    }
+    if (recordPath && !startRecording(recordPath)) {
+        return -1;
+    }
     
-    sf::RenderWindow window(sf::VideoMode(SCREEN_WIDTH, SCREEN_HEIGHT), "Centipede", sf::Style::Close);
-    window.setSize(sf::Vector2u(640, 640));
-    window.setPosition(sf::Vector2i(100, 0));
+    if (headless) {
+        if (capturePrefix) {
+            std::cerr << "Capture needs a window; it cannot be used with --headless" << std::endl;
+            return -1;
+        }
+        if (telemetryPath && !startTelemetry(telemetryPath, telemetryFormat)) {
+            return -1;
+        }
+        if ((metricsPort || metricsPath) && !startMetricsExport(metricsPort, metricsPath)) {
+            stopTelemetry();
+            return -1;
+        }
+        if (!startWatchdog(flightDirectory, frameBudgetMicros, tickBudgetMicros, hangSeconds)) {
+            stopTelemetry();
+            stopMetricsExport();
+            return -1;
+        }
+        if (tuningPath && !startTuningWatch(tuningPath)) {
+            stopWatchdog();
+            stopTelemetry();
+            stopMetricsExport();
+            return -1;
+        }
+        int result = runHeadless(maxTicks);
+        printAllocationSummary();
+        stopTuningWatch();
+        stopArena();
+        stopWatchdog();
+        stopRecording();
+        stopTelemetry();
+        stopMetricsExport();
+        return result;
+    }
+    
+    // The window is created at the size it is shown at; the game's logical
+    // SCREEN_WIDTH x SCREEN_HEIGHT space is mapped onto it by Display
+    sf::RenderWindow window;
+    if (fullscreen) {
+        window.create(sf::VideoMode::getDesktopMode(), "Centipede", sf::Style::Fullscreen);
+    } else {
+        window.create(sf::VideoMode(windowSize, windowSize), "Centipede", sf::Style::Default);
+        window.setPosition(sf::Vector2i(100, 0));
+    }
+    if (!setupDisplay(window, internalSize)) {
+        return -1;
+    }
     
     // Resources
     sf::Music bgMusic;
     sf::Font font;
     sf::Texture backgroundTexture, mushroomTexture, poisonMushroomTexture;
-    sf::Texture centipedeTexture, headTexture, playerTexture, bulletTexture;
+    sf::Texture playerTexture, bulletTexture;
     
     // Load resources
     if (!loadResources(backgroundTexture, mushroomTexture, poisonMushroomTexture,
-                       centipedeTexture, headTexture, playerTexture, bulletTexture,
-                       font, bgMusic)) {
+                       playerTexture, bulletTexture, font, bgMusic)) {
+        return -1;
+    }
+    if (!loadCentipedeSheets()) {
+        return -1;
+    }
+    if (!loadEffects()) {
         return -1;
     }
     
@@ -143,145 +389,288 @@ int main() {
     sf::Sprite poisonMushroomSprite(poisonMushroomTexture);
     poisonMushroomSprite.setTextureRect(sf::IntRect(0, 0, TILE_SIZE, TILE_SIZE));
     
-    sf::Sprite centipedeSprite(centipedeTexture);
-    centipedeSprite.setTextureRect(sf::IntRect(0, 0, TILE_SIZE, TILE_SIZE));
-    
-    sf::Sprite headSprite(headTexture);
-    headSprite.setTextureRect(sf::IntRect(0, 0, TILE_SIZE, TILE_SIZE));
-    
     sf::Sprite playerSprite(playerTexture);
     playerSprite.setTextureRect(sf::IntRect(0, 0, TILE_SIZE, TILE_SIZE));
     
-    sf::Sprite bulletSprite(bulletTexture);
-    bulletSprite.setTextureRect(sf::IntRect(0, 0, TILE_SIZE, TILE_SIZE));
     
-    sf::Text scoreText;
-    scoreText.setFont(font);
-    scoreText.setCharacterSize(31); // Increased by 30% from 24
-    scoreText.setFillColor(sf::Color::Green);
-    scoreText.setPosition(10, 10);
+    buildScreenTexts(font);
     
-    initializeGame();
+    if (telemetryPath && !startTelemetry(telemetryPath, telemetryFormat)) {
+        return -1;
+    }
+    if ((metricsPort || metricsPath) && !startMetricsExport(metricsPort, metricsPath)) {
+        stopTelemetry();
+        return -1;
+    }
+    if (!startWatchdog(flightDirectory, frameBudgetMicros, tickBudgetMicros, hangSeconds)) {
+        stopTelemetry();
+        stopMetricsExport();
+        return -1;
+    }
+    if (capturePrefix && !startCapture(capturePrefix, captureFormat, captureFramesPerSecond)) {
+        stopWatchdog();
+        stopTelemetry();
+        stopMetricsExport();
+        return -1;
+    }
+    if (tuningPath && !startTuningWatch(tuningPath)) {
+        stopCapture();
+        stopWatchdog();
+        stopTelemetry();
+        stopMetricsExport();
+        return -1;
+    }
+    if (spectateGames) {
+        SpectatorTextures textures = {&mushroomTexture, &poisonMushroomTexture, &playerTexture, &bulletTexture,
+                                      &centipedeAtlas, &bodyWalk, &headWalk};
+        int result = 0;
+        if (startSpectator(spectateGames, spectateThreads, randomState, autopilotBudgetMicros, textures, font)) {
+            runSpectatorLoop(window, backgroundSprite);
+            cout << spectatorGamesPlayed() << " games finished across " << spectateGames << " tiles" << endl;
+            stopSpectator();
+        } else {
+            std::cerr << "Failed to build the spectator atlas!" << std::endl;
+            result = -1;
+        }
+        printAllocationSummary();
+        stopCapture();
+        stopWatchdog();
+        stopTelemetry();
+        stopMetricsExport();
+        return result;
+    }
+    if (hostPort || joinAddress) {
+        netSession = hostPort ? hostNetSession(hostPort, randomState) : joinNetSession(joinAddress);
+        if (!netSession) {
+            stopTuningWatch();
+            stopCapture();
+            stopWatchdog();
+            stopTelemetry();
+            stopMetricsExport();
+            return -1;
+        }
+        setNetConditions(netSession, netLatencyMillis, netLossPercent);
+        if (hostPort) cout << "Hosting co-op on port " << netSessionPort(netSession) << endl;
+        currentGameState = GAME_STATE; // The game starts once the peers find each other
+    } else {
+        resetGame();
+    }
     
     sf::Clock gameClock;
-    float deltaTime = 0.0f;
-    sf::Clock centipedeClock;
+    long long tickAccumulator = 0; // Real time not yet simulated, in microseconds
     
     loadHighScores();
+    
+    bool windowFocused = true;
+    int drawnState = -1; // Screen shown by the last frame drawn
+    bool drawnPaused = false;
 
     while (window.isOpen() && !gameOver) {
-        deltaTime = gameClock.restart().asSeconds();
-        
+        // Idle screens block until the next event; while effects play on
+        // them they wake once per animation frame instead
         sf::Event event;
-        while (window.pollEvent(event)) {
+        bool pendingEvent = false;
+        bool waited = false;
+        bool idleBefore = isIdleScreen() && drawnState == currentGameState && drawnPaused == gamePaused;
+        if (idleBefore && effectsActive()) {
+            sf::sleep(sf::milliseconds(ANIMATION_FRAME_MS));
+        } else if (idleBefore) {
+            setWatchdogIdle(true);
+            pendingEvent = window.waitEvent(event);
+            setWatchdogIdle(false);
+            waited = true;
+        } else if (!windowFocused) {
+            sf::sleep(sf::milliseconds(UNFOCUSED_FRAME_MS));
+        }
+        long long frameMicros = gameClock.restart().asMicroseconds();
+        if (waited) frameMicros = 0; // Time spent waiting is not game time
+        beginFlightFrame();
+        beginAllocationFrame();
+        
+        bool eventsArrived = false;
+        while (pendingEvent || window.pollEvent(event)) {
+            pendingEvent = false;
+            eventsArrived = true;
             if (event.type == sf::Event::Closed) {
                 window.close();
             }
+            if (event.type == sf::Event::Resized) {
+                resizeDisplay(window);
+            }
+            if (event.type == sf::Event::LostFocus) {
+                windowFocused = false;
+                // A human player gets a pause; the autopilot keeps going at a lower frame rate
+                // Co-op cannot pause: the other player's game would stall
+                if (currentGameState == GAME_STATE && !autopilotEnabled && !netSession) gamePaused = true;
+            }
+            if (event.type == sf::Event::GainedFocus) {
+                windowFocused = true;
+            }
             if (currentGameState == MENU_STATE || currentGameState == HIGH_SCORE_STATE || currentGameState == GAME_OVER_STATE) {
                 handleMenuInput(event, window);
             }
             if (currentGameState == GAME_STATE && event.type == sf::Event::KeyPressed && 
-                event.key.code == sf::Keyboard::P) {
+                event.key.code == sf::Keyboard::P && !netSession) {
                 gamePaused = !gamePaused;
             }
             if (currentGameState == GAME_STATE && event.type == sf::Event::KeyPressed && 
                 event.key.code == sf::Keyboard::Escape) {
-                updateHighScores(score);
+                if (!autopilotEnabled) updateHighScores(score);
                 currentGameState = GAME_OVER_STATE;
                 playerWon = false; // Reset win condition
+                if (netSession) {
+                    closeNetSession(netSession);
+                    netSession = nullptr;
+                }
             }
         }
-        window.clear();
-        window.draw(backgroundSprite);
+        // The autopilot keeps an unattended session going by restarting straight away
+        if (autopilotEnabled && currentGameState != GAME_STATE) {
+            currentGameState = GAME_STATE;
+            resetGame();
+            tickAccumulator = 0;
+        }
+        markPhase(PHASE_EVENTS);
+        
+        // Nothing on an idle screen changes without input, a new screen or effects
+        if (isIdleScreen() && !eventsArrived && drawnState == currentGameState &&
+            drawnPaused == gamePaused && !effectsActive()) {
+            endFlightFrame(0, playerInput);
+            endAllocationFrame();
+            continue;
+        }
+        drawnState = currentGameState;
+        drawnPaused = gamePaused;
+        addMetric(METRIC_FRAMES, 1);
+        observeHistogram(HISTOGRAM_FRAME_TIME, frameMicros * 1000);
+        
+        sf::RenderTarget& target = beginFrame(window);
+        target.draw(backgroundSprite);
+        addMetric(METRIC_DRAW_CALLS, 1);
+        markPhase(PHASE_DRAW);
+        int ticksRun = 0;
         
         switch (currentGameState) {
             case MENU_STATE:
-                drawMenu(window, font);
+                drawMenu(target);
                 break;
                 
             case HIGH_SCORE_STATE:
-                drawHighScores(window, font);
+                drawHighScores(target);
                 break;
                 
             case GAME_OVER_STATE:
-                drawGameOverMenu(window, font);
+                drawGameOverMenu(target);
                 break;
                 
             case GAME_STATE:
-                sf::Time deltaTime = gameClock.restart();
-                float dt = deltaTime.asSeconds();
-                
+                if (netSession && !pollNetSession(netSession)) {
+                    target.draw(screenTexts[TEXT_WAITING]);
+                    addMetric(METRIC_DRAW_CALLS, 1);
+                    break;
+                }
+                markPhase(PHASE_SIMULATION); // Polling the session may roll back and replay ticks
                 if (!gamePaused) {
-                    handleInput(dt, window);
-                    
-                    if (centipedeClock.getElapsedTime().asMilliseconds() > 10) {
-                        moveCentipede(dt);
-                        centipedeClock.restart();
-                    }
-                    
-                    if (bullet[EXISTS]) {
-                        moveBullet(dt);
-                    }
-                    
-                    // Spawn new heads if any group is in player area
-                    bool anyGroupInPlayerArea = false;
-                    for (int i = 0; i < groupCount; ++i) {
-                        if (groupInPlayerArea[i]) {
-                            anyGroupInPlayerArea = true;
+                    tickAccumulator += frameMicros;
+                    while (tickAccumulator >= MICROS_PER_TICK && currentGameState == GAME_STATE) {
+                        if (autopilotEnabled) {
+                            chooseAutopilotInput(playerInput);
+                        } else {
+                            readKeyboardInput(window, playerInput);
+                        }
+                        markPhase(PHASE_INPUT);
+                        
+                        applyTuningUpdate();
+                        rememberLiveObjects();
+                        unsigned long long checksBefore = collisionChecks;
+                        chrono::steady_clock::time_point tickStart = chrono::steady_clock::now();
+                        int outcome = netSession ? netplayTick(netSession, playerInput) : updateGame(playerInput);
+                        if (outcome == NET_STALLED) {
+                            tickAccumulator = 0; // Waiting for the other player; that time is dropped
+                            break;
+                        }
+                        long long tickNanos = chrono::duration_cast<chrono::nanoseconds>(
+                                                  chrono::steady_clock::now() - tickStart).count();
+                        noteTickTime(tickNanos);
+                        recordTick(playerInput);
+                        spawnKillEffects(outcome);
+                        if (isArenaActive()) {
+                            outcome = updateArena(playerInput, outcome); // After the effects: it may swap chunks
+                        }
+                        recordTickMetrics(tickNanos, collisionChecks - checksBefore, outcome);
+                        if (outcome != TICK_RUNNING && netSession) {
+                            closeNetSession(netSession); // The game is over for both players
+                            netSession = nullptr;
+                        }
+                        if (outcome == TICK_PLAYER_WON) {
+                            if (!autopilotEnabled) updateHighScores(score);
+                            currentGameState = MENU_STATE;
+                        } else if (outcome == TICK_PLAYER_DIED) {
+                            if (!autopilotEnabled) updateHighScores(score);
+                            currentGameState = GAME_OVER_STATE;
+                            playerWon = false; // Reset win condition
+                        }
+                        
+                        markPhase(PHASE_SIMULATION);
+                        
+                        tickAccumulator -= MICROS_PER_TICK;
+                        if (++ticksRun == MAX_TICKS_PER_FRAME) {
+                            tickAccumulator = 0;
                             break;
                         }
-                    }
-                    if (anyGroupInPlayerArea && headSpawnClock.getElapsedTime().asSeconds() >= HEAD_SPAWN_INTERVAL) {
-                        spawnNewHead();
-                        headSpawnClock.restart();
-                    }
-                    
-                    checkCentipedeMushroomCollisions();
-                    checkBulletMushroomCollisions();
-                    checkBulletCentipedeCollisions();
-                    
-                    if (checkPlayerCentipedeCollision()) {
-                        updateHighScores(score);
-                        currentGameState = GAME_OVER_STATE;
-                        playerWon = false; // Reset win condition
                     }
                 }
                 
-                drawMushrooms(window, mushroomSprite, poisonMushroomSprite);
-                drawCentipede(window, centipedeSprite, headSprite);
-                drawPlayer(window, playerSprite);
-                
-                if (bullet[EXISTS]) {
-                    drawBullet(window, bulletSprite);
+                markPhase(PHASE_SIMULATION);
+                updateWorldGauges();
+                drawMushrooms(target, mushroomSprite, poisonMushroomSprite);
+                if (!gamePaused) {
+                    advanceWalkClocks(frameMicros / 1000000.0f);
                 }
+                drawCentipede(target);
+                drawPlayer(target, playerSprite);
+                
+                drawProjectiles(target, bulletTexture);
                 
-                renderScore(window, scoreText);
+                renderScore(target, font);
                 
                 if (gamePaused) {
-                    sf::Text pausedText;
-                    pausedText.setFont(font);
-                    pausedText.setString("PAUSED");
-                    pausedText.setCharacterSize(50);
-                    pausedText.setFillColor(sf::Color::White);
-                    pausedText.setPosition(
-                        SCREEN_WIDTH / 2 - pausedText.getGlobalBounds().width / 2,
-                        SCREEN_HEIGHT / 2 - pausedText.getGlobalBounds().height / 2
-                    );
-                    window.draw(pausedText);
+                    target.draw(screenTexts[TEXT_PAUSED]);
+                    addMetric(METRIC_DRAW_CALLS, 1);
                 }
                 break;
         }
         
-        window.display();
+        // Effects play out over whichever screen follows a death or win
+        if (!gamePaused) {
+            updateEffects(frameMicros / 1000000.0f);
+        }
+        drawEffects(target);
+        markPhase(PHASE_DRAW);
+        
+        endFrame(window);
+        markPhase(PHASE_DISPLAY);
+        endFlightFrame(ticksRun, playerInput);
+        endAllocationFrame();
     }
     
+    if (netSession) {
+        closeNetSession(netSession);
+    }
+    printAllocationSummary();
+    stopTuningWatch();
+    stopArena();
+    stopCapture();
+    stopWatchdog();
+    stopRecording();
+    stopTelemetry();
+    stopMetricsExport();
     return 0;
 }
 
 bool loadResources(sf::Texture& backgroundTexture, sf::Texture& mushroomTexture,
-                  sf::Texture& poisonMushroomTexture, sf::Texture& centipedeTexture,
-                  sf::Texture& headTexture, sf::Texture& playerTexture, sf::Texture& bulletTexture,
-                  sf::Font& font, sf::Music& bgMusic) {
+                  sf::Texture& poisonMushroomTexture, sf::Texture& playerTexture,
+                  sf::Texture& bulletTexture, sf::Font& font, sf::Music& bgMusic) {
     if (!backgroundTexture.loadFromFile("Textures/background1.jpg")) {
         std::cerr << "Failed to load background texture!" << std::endl;
         return false;
@@ -294,14 +683,6 @@ bool loadResources(sf::Texture& backgroundTexture, sf::Texture& mushroomTexture,
         std::cerr << "Failed to load poisonous mushroom texture!" << std::endl;
         return false;
     }
-    if (!centipedeTexture.loadFromFile("Textures/c_body_left_walk.png")) {
-        std::cerr << "Failed to load centipede texture!" << std::endl;
-        return false;
-    }
-    if (!headTexture.loadFromFile("Textures/c_head_left_walk.png")) {
-        std::cerr << "Failed to load head texture!" << std::endl;
-        return false;
-    }
     if (!playerTexture.loadFromFile("Textures/player.png")) {
         std::cerr << "Failed to load player texture!" << std::endl;
         return false;
@@ -324,73 +705,9 @@ bool loadResources(sf::Texture& backgroundTexture, sf::Texture& mushroomTexture,
     return true;
 }
 
-void initializeGame() {
-    // Initialize player position within bottom 5 rows
-    player[X] = (GRID_COLS / 2) * TILE_SIZE;
-    player[Y] = (GRID_ROWS - 5) * TILE_SIZE; // Spawn at top of bottom 5 rows
-    
-    // Initialize bullet
-    bullet[X] = player[X];
-    bullet[Y] = player[Y] - TILE_SIZE;
-    bullet[EXISTS] = false;
-    
-    // Reset score
-    score = 0;
-    
-    // Initialize game objects
-    initializeMushrooms();
-    initializeCentipede();
-    
-    // Reset game state
-    gameOver = false;
-    moveLeft = true;
-    playerWon = false;
-}
-
-void initializeMushrooms() {
-    for (int i = 0; i < NUM_MUSHROOMS; ++i) {
-        bool uniquePosition = false;
-        int newX, newY;
-
-        // Keep generating positions until a unique one is found
-        while (!uniquePosition) {
-            newX = rand() % GRID_COLS * TILE_SIZE;
-            newY = rand() % (GRID_ROWS - MAX_PLAYER_ROWS) * TILE_SIZE;
-            uniquePosition = true;
-
-            // Check against all previously placed mushrooms
-            for (int j = 0; j < i; ++j) {
-                if (mushroomGrid[j][EXISTS] && mushroomGrid[j][X] == newX && mushroomGrid[j][Y] == newY) {
-                    uniquePosition = false;
-                    break;
-                }
-            }
-        }
-
-        // Assign the unique position and initialize all fields
-        mushroomGrid[i][X] = newX;
-        mushroomGrid[i][Y] = newY;
-        mushroomGrid[i][EXISTS] = true;
-        mushroomGrid[i][DAMAGE] = 0;
-        mushroomGrid[i][IS_POISONOUS] = false; // Initialize as non-poisonous
-    }
-}
-
-void initializeCentipede() {
-    for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
-        centipedeGrid[i][X] = (GRID_COLS - i - 1) * TILE_SIZE; // Start from right
-        centipedeGrid[i][Y] = 0;
-        centipedeGrid[i][EXISTS] = true;
-        centipedeGroup[i] = 0; // All segments start in group 0
-    }
-    groupMoveLeft[0] = true; // Initial group moves left
-    groupInPlayerArea[0] = false; // Start outside player area
-    groupCount = 1; // Start with one group
-    headSpawnClock.restart(); // Initialize spawn timer
-}
-
-void drawMushrooms(sf::RenderWindow& window, sf::Sprite& mushroomSprite, 
+void drawMushrooms(sf::RenderTarget& target, sf::Sprite& mushroomSprite, 
                   sf::Sprite& poisonMushroomSprite) {
+    int drawCalls = 0;
     for (int i = 0; i < NUM_MUSHROOMS; ++i) {
         if (mushroomGrid[i][EXISTS]) {
             int damage = mushroomGrid[i][DAMAGE];
@@ -398,332 +715,304 @@ void drawMushrooms(sf::RenderWindow& window, sf::Sprite& mushroomSprite,
             
             if (mushroomGrid[i][IS_POISONOUS]) {
                 poisonMushroomSprite.setTextureRect(sf::IntRect(textureX, 0, TILE_SIZE, TILE_SIZE));
-                poisonMushroomSprite.setPosition(mushroomGrid[i][X], mushroomGrid[i][Y]);
-                window.draw(poisonMushroomSprite);
+                poisonMushroomSprite.setPosition(toPixels(mushroomGrid[i][X]), toPixels(mushroomGrid[i][Y]));
+                target.draw(poisonMushroomSprite);
             } else {
                 mushroomSprite.setTextureRect(sf::IntRect(textureX, 0, TILE_SIZE, TILE_SIZE));
-                mushroomSprite.setPosition(mushroomGrid[i][X], mushroomGrid[i][Y]);
-                window.draw(mushroomSprite);
+                mushroomSprite.setPosition(toPixels(mushroomGrid[i][X]), toPixels(mushroomGrid[i][Y]));
+                target.draw(mushroomSprite);
             }
+            drawCalls++;
         }
     }
+    addMetric(METRIC_DRAW_CALLS, drawCalls);
 }
 
-void drawCentipede(sf::RenderWindow& window, sf::Sprite& centipedeSprite, sf::Sprite& headSprite) {
-    for (int group = 0; group < groupCount; ++group) {
-        // Find the head of the current group based on movement direction
-        int headIndex = -1;
-        if (groupMoveLeft[group]) {
-            int minX = SCREEN_WIDTH;
-            for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
-                if (centipedeGrid[i][EXISTS] && centipedeGroup[i] == group && centipedeGrid[i][X] < minX) {
-                    minX = centipedeGrid[i][X];
-                    headIndex = i;
-                }
-            }
-        } else {
-            int maxX = -1;
-            for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
-                if (centipedeGrid[i][EXISTS] && centipedeGroup[i] == group && centipedeGrid[i][X] > maxX) {
-                    maxX = centipedeGrid[i][X];
-                    headIndex = i;
-                }
-            }
-        }
-
-        for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
-            if (centipedeGrid[i][EXISTS] && centipedeGroup[i] == group) {
-                bool isHead = (i == headIndex);
-                if (isHead) {
-                    headSprite.setPosition(centipedeGrid[i][X], centipedeGrid[i][Y]);
-                    if (groupMoveLeft[group]) {
-                        headSprite.setScale(1.0f, 1.0f); // Normal (left-facing)
-                    } else {
-                        headSprite.setScale(-1.0f, 1.0f); // Flip horizontally (right-facing)
-                        headSprite.setPosition(centipedeGrid[i][X] + TILE_SIZE, centipedeGrid[i][Y]);
-                    }
-                    window.draw(headSprite);
-                } else {
-                    centipedeSprite.setPosition(centipedeGrid[i][X], centipedeGrid[i][Y]);
-                    window.draw(centipedeSprite);
-                }
-            }
-        }
+bool loadCentipedeSheets() {
+    sf::Image bodyImage, headImage, atlasImage;
+    if (!bodyImage.loadFromFile("Textures/c_body_left_walk.png")) {
+        std::cerr << "Failed to load centipede texture!" << std::endl;
+        return false;
+    }
+    if (!headImage.loadFromFile("Textures/c_head_left_walk.png")) {
+        std::cerr << "Failed to load head texture!" << std::endl;
+        return false;
     }
+    
+    // Body frames on the top row, head frames below
+    unsigned int atlasWidth = max(bodyImage.getSize().x, headImage.getSize().x);
+    atlasImage.create(atlasWidth, TILE_SIZE * 2, sf::Color::Transparent);
+    atlasImage.copy(bodyImage, 0, 0);
+    atlasImage.copy(headImage, 0, TILE_SIZE);
+    if (!centipedeAtlas.loadFromImage(atlasImage)) {
+        std::cerr << "Failed to build centipede atlas!" << std::endl;
+        return false;
+    }
+    
+    sliceAnimation(bodyWalk, 0, 0, TILE_SIZE, bodyImage.getSize().x / TILE_SIZE, WALK_FRAMES_PER_SECOND);
+    sliceAnimation(headWalk, 0, TILE_SIZE, TILE_SIZE, headImage.getSize().x / TILE_SIZE, WALK_FRAMES_PER_SECOND);
+    return true;
 }
 
-bool checkCollision(float x1, float y1, int w1, int h1, float x2, float y2, int w2, int h2) {
-    return (x1 < x2 + w2 && x1 + w1 > x2 && y1 < y2 + h2 && y1 + h1 > y2);
+void advanceWalkClocks(float seconds) {
+    for (int group = 0; group < groupCount; ++group) {
+        groupWalkClock[group] += seconds;
+    }
 }
 
-void checkCentipedeMushroomCollisions() {
-    for (int i = 0; i < NUM_MUSHROOMS; ++i) {
-        if (mushroomGrid[i][EXISTS]) {
-            for (int j = 0; j < CENTIPEDE_LENGTH; ++j) {
-                if (centipedeGrid[j][EXISTS]) {
-                    if (checkCollision(
-                        centipedeGrid[j][X], centipedeGrid[j][Y], TILE_SIZE, TILE_SIZE,
-                        mushroomGrid[i][X], mushroomGrid[i][Y], TILE_SIZE, TILE_SIZE)) {
-                        
-                        // Move centipede down and change direction
-                        int group = centipedeGroup[j];
-                        groupMoveLeft[group] = !groupMoveLeft[group];
-                        for (int k = 0; k < CENTIPEDE_LENGTH; ++k) {
-                            if (centipedeGrid[k][EXISTS] && centipedeGroup[k] == group) {
-                                int currentRow = centipedeGrid[k][Y] / TILE_SIZE;
-                                int nextRow = currentRow + 1;
-                                if (groupInPlayerArea[group] && nextRow > GRID_ROWS - 1) {
-                                    nextRow = GRID_ROWS - MAX_PLAYER_ROWS; // Wrap to top of player area
-                                }
-                                centipedeGrid[k][Y] = nextRow * TILE_SIZE;
-                            }
-                        }
-                        return;
-                    }
-                }
-            }
+void drawCentipede(sf::RenderTarget& target) {
+    int quadCount = 0;
+    for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
+        if (centipedeGrid[i][EXISTS]) {
+            int group = centipedeGroup[i];
+            bool isHead = (i == groupHead[group]);
+            const Animation& walk = isHead ? headWalk : bodyWalk;
+            
+            // Each segment faces the way it moved at its point on the path
+            int entry = (groupPathHead[group] - segmentLag[i] * segmentSpacing) & (PATH_LENGTH - 1);
+            bool movingLeft = isHead ? groupMoveLeft[group] : centipedePath[group][entry][PATH_MOVE_LEFT] != 0;
+            
+            // One clock per group; the lag offset ripples the walk down the body
+            int frame = (animationFrame(walk, groupWalkClock[group]) + segmentLag[i]) % walk.frameCount;
+            
+            // The sheets face left
+            writeAnimationQuad(&centipedeVertices[quadCount * 4], walk, frame, !movingLeft,
+                               toPixels(centipedeGrid[i][X]), toPixels(centipedeGrid[i][Y]), TILE_SIZE);
+            quadCount++;
         }
     }
+    target.draw(centipedeVertices, quadCount * 4, sf::Quads, sf::RenderStates(&centipedeAtlas));
+    addMetric(METRIC_DRAW_CALLS, 1);
 }
 
-void checkBulletMushroomCollisions() {
-    if (!bullet[EXISTS]) return;
-    
-    for (int i = 0; i < NUM_MUSHROOMS; ++i) {
-        if (mushroomGrid[i][EXISTS]) {
-            if (checkCollision(
-                bullet[X], bullet[Y], TILE_SIZE, TILE_SIZE,
-                mushroomGrid[i][X], mushroomGrid[i][Y], TILE_SIZE, TILE_SIZE)) {
-                
-                // Increase damage level
-                mushroomGrid[i][DAMAGE]++;
-                
-                // Check if mushroom should be destroyed
-                if (mushroomGrid[i][DAMAGE] >= 4) {
-                    mushroomGrid[i][EXISTS] = false;
-                    score += 1;
-                }
-                
-                // Reset bullet
-                bullet[EXISTS] = false;
-                return;
-            }
-        }
+void drawProjectiles(sf::RenderTarget& target, const sf::Texture& bulletTexture) {
+    if (projectileCount == 0) return;
+    const float size = TILE_SIZE;
+    for (int p = 0; p < projectileCount; ++p) {
+        float x = toPixels(projectileX[p]), y = toPixels(projectileY[p]);
+        sf::Color color = projectileOwner[p] == FIGHTER_PARTNER ? PARTNER_TINT : sf::Color::White;
+        sf::Vertex* quad = &projectileVertices[p * 4];
+        quad[0] = sf::Vertex(sf::Vector2f(x, y), color, sf::Vector2f(0, 0));
+        quad[1] = sf::Vertex(sf::Vector2f(x + size, y), color, sf::Vector2f(size, 0));
+        quad[2] = sf::Vertex(sf::Vector2f(x + size, y + size), color, sf::Vector2f(size, size));
+        quad[3] = sf::Vertex(sf::Vector2f(x, y + size), color, sf::Vector2f(0, size));
     }
+    target.draw(projectileVertices, projectileCount * 4, sf::Quads, sf::RenderStates(&bulletTexture));
+    addMetric(METRIC_DRAW_CALLS, 1);
 }
 
-bool checkPlayerCentipedeCollision() {
-    for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
-        if (centipedeGrid[i][EXISTS]) {
-            if (checkCollision(
-                player[X], player[Y], TILE_SIZE, TILE_SIZE,
-                centipedeGrid[i][X], centipedeGrid[i][Y], TILE_SIZE, TILE_SIZE)) {
-                return true;
-            }
-        }
+void drawPlayer(sf::RenderTarget& target, sf::Sprite& playerSprite) {
+    playerSprite.setPosition(toPixels(player[X]), toPixels(player[Y]));
+    target.draw(playerSprite);
+    addMetric(METRIC_DRAW_CALLS, 1);
+    if (coopGame) {
+        playerSprite.setColor(PARTNER_TINT);
+        playerSprite.setPosition(toPixels(partner[X]), toPixels(partner[Y]));
+        target.draw(playerSprite);
+        playerSprite.setColor(sf::Color::White);
+        addMetric(METRIC_DRAW_CALLS, 1);
     }
-    return false;
 }
 
-void moveBullet(float deltaTime) {
-    const float bulletSpeed = 5000.0f * deltaTime; // Pixels per second
-    
-    bullet[Y] -= bulletSpeed;
-    
-    // Bullet goes off screen
-    if (bullet[Y] < -TILE_SIZE) {
-        bullet[EXISTS] = false;
-    }
+void readKeyboardInput(sf::RenderWindow& window, bool input[]) {
+    input[INPUT_LEFT] = sf::Keyboard::isKeyPressed(sf::Keyboard::Left);
+    input[INPUT_RIGHT] = sf::Keyboard::isKeyPressed(sf::Keyboard::Right);
+    input[INPUT_UP] = sf::Keyboard::isKeyPressed(sf::Keyboard::Up);
+    input[INPUT_DOWN] = sf::Keyboard::isKeyPressed(sf::Keyboard::Down);
+    input[INPUT_FIRE] = isSpaceKeyPressed(window);
 }
 
-void drawBullet(sf::RenderWindow& window, sf::Sprite& bulletSprite) {
-    bulletSprite.setPosition(bullet[X], bullet[Y]);
-    window.draw(bulletSprite);
+bool isSpaceKeyPressed(sf::RenderWindow& window) {
+    return sf::Keyboard::isKeyPressed(sf::Keyboard::Space);
 }
 
-void drawPlayer(sf::RenderWindow& window, sf::Sprite& playerSprite) {
-    playerSprite.setPosition(player[X], player[Y]);
-    window.draw(playerSprite);
+bool isIdleScreen() {
+    if (autopilotEnabled) return false;
+    return currentGameState != GAME_STATE || gamePaused;
 }
 
-void handleInput(float deltaTime, sf::RenderWindow& window) {
-    const float playerSpeed = 1200.0f * deltaTime; // Pixels per second
-    
-    // Player movement
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left) && player[X] > 0) {
-        player[X] -= playerSpeed;
-    }
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right) && player[X] < SCREEN_WIDTH - TILE_SIZE) {
-        player[X] += playerSpeed;
+void recordTickMetrics(long long tickNanos, unsigned long long collisionPairs, int outcome) {
+    addMetric(METRIC_TICKS, 1);
+    addMetric(METRIC_COLLISION_PAIRS, collisionPairs);
+    observeHistogram(HISTOGRAM_TICK_TIME, tickNanos);
+    if (outcome != TICK_RUNNING) addMetric(METRIC_GAMES, 1);
+}
+
+void updateWorldGauges() {
+    int liveSegments = 0, liveMushrooms = 0;
+    for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
+        if (centipedeGrid[i][EXISTS]) liveSegments++;
     }
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up) && 
-        player[Y] > (GRID_ROWS - MAX_PLAYER_ROWS) * TILE_SIZE) {
-        player[Y] -= playerSpeed;
+    for (int i = 0; i < NUM_MUSHROOMS; ++i) {
+        if (mushroomGrid[i][EXISTS]) liveMushrooms++;
     }
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down) && player[Y] < SCREEN_HEIGHT - TILE_SIZE) {
-        player[Y] += playerSpeed;
+    setMetric(METRIC_LIVE_SEGMENTS, liveSegments);
+    setMetric(METRIC_LIVE_MUSHROOMS, liveMushrooms);
+    setMetric(METRIC_GROUPS, groupCount);
+    setMetric(METRIC_LIVE_PROJECTILES, projectileCount);
+    setMetric(METRIC_SCORE, score);
+    setMetric(METRIC_TELEMETRY_DROPPED, telemetryDroppedEvents());
+}
+
+void rememberLiveObjects() {
+    for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
+        segmentWasAlive[i] = centipedeGrid[i][EXISTS];
     }
-    
-    // Fire bullet
-    if (isSpaceKeyPressed(window) && !bullet[EXISTS]) {
-        bullet[X] = player[X];
-        bullet[Y] = player[Y] - TILE_SIZE;
-        bullet[EXISTS] = true;
+    for (int i = 0; i < NUM_MUSHROOMS; ++i) {
+        mushroomWasAlive[i] = mushroomGrid[i][EXISTS];
     }
 }
 
-bool isSpaceKeyPressed(sf::RenderWindow& window) {
-    return sf::Keyboard::isKeyPressed(sf::Keyboard::Space);
+void spawnKillEffects(int outcome) {
+    // Destroyed objects keep their last position
+    const float HALF_TILE = TILE_SIZE / 2.0f;
+    for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
+        if (segmentWasAlive[i] && !centipedeGrid[i][EXISTS]) {
+            spawnExplosion(toPixels(centipedeGrid[i][X]) + HALF_TILE, toPixels(centipedeGrid[i][Y]) + HALF_TILE, 16);
+        }
+    }
+    for (int i = 0; i < NUM_MUSHROOMS; ++i) {
+        if (mushroomWasAlive[i] && !mushroomGrid[i][EXISTS]) {
+            spawnExplosion(toPixels(mushroomGrid[i][X]) + HALF_TILE, toPixels(mushroomGrid[i][Y]) + HALF_TILE, 8);
+        }
+    }
+    if (outcome == TICK_PLAYER_DIED) {
+        spawnPlayerDeath(toPixels(player[X]) + HALF_TILE, toPixels(player[Y]) + HALF_TILE);
+    }
 }
 
 void resetGame() {
-    initializeGame();
+    if (isArenaActive()) {
+        resetArena();
+    } else {
+        initializeGame();
+    }
+    recordReset();
+    gameOver = false;
 }
 
-void renderScore(sf::RenderWindow& window, sf::Text& scoreText) {
-    scoreText.setString("Score: " + std::to_string(score));
-    window.draw(scoreText);
+// Centers a text horizontally at height y
+static void layoutText(int text, sf::Font& font, const char* string, unsigned int size,
+                       sf::Color color, float y) {
+    sf::Text& item = screenTexts[text];
+    item.setFont(font);
+    item.setString(string);
+    item.setCharacterSize(size);
+    item.setFillColor(color);
+    item.setPosition(SCREEN_WIDTH / 2 - item.getGlobalBounds().width / 2, y);
 }
 
-void drawMenu(sf::RenderWindow& window, sf::Font& font) {
-    sf::Text titleText, playText, scoresText, exitText, winText;
+static void highlightText(int text, bool selected) {
+    sf::Text& item = screenTexts[text];
+    item.setFillColor(selected ? sf::Color::Yellow : sf::Color::White);
+    if (selected) {
+        item.setScale(1.1f, 1.1f); // Hover effect
+    } else {
+        item.setScale(1.0f, 1.0f);
+    }
+}
+
+void buildScreenTexts(sf::Font& font) {
+    // Main menu
+    layoutText(TEXT_MENU_TITLE, font, "CENTIPEDE", 60, sf::Color::Green, SCREEN_HEIGHT / 4);
+    layoutText(TEXT_MENU_WIN, font, "You Won!", 40, sf::Color::Yellow, SCREEN_HEIGHT / 4 + 80);
+    layoutText(TEXT_MENU_PLAY, font, "Play Game", 36, sf::Color::White, SCREEN_HEIGHT / 2);
+    layoutText(TEXT_MENU_HIGH_SCORES, font, "High Scores", 36, sf::Color::White, SCREEN_HEIGHT / 2 + 60);
+    layoutText(TEXT_MENU_EXIT, font, "Exit", 36, sf::Color::White, SCREEN_HEIGHT / 2 + 120);
     
-    // Title
-    titleText.setFont(font);
-    titleText.setString("CENTIPEDE");
-    titleText.setCharacterSize(60);
-    titleText.setFillColor(sf::Color::Green);
-    titleText.setPosition(
-        SCREEN_WIDTH / 2 - titleText.getGlobalBounds().width / 2,
-        SCREEN_HEIGHT / 4
-    );
+    // Game over menu
+    layoutText(TEXT_GAME_OVER_TITLE, font, "GAME OVER", 60, sf::Color::Red, SCREEN_HEIGHT / 4);
+    layoutText(TEXT_GAME_OVER_MAIN_MENU, font, "Return to Main Menu", 36, sf::Color::White, SCREEN_HEIGHT / 2);
+    layoutText(TEXT_GAME_OVER_RESTART, font, "Restart", 36, sf::Color::White, SCREEN_HEIGHT / 2 + 60);
+    layoutText(TEXT_GAME_OVER_LEADERBOARD, font, "View Leaderboard", 36, sf::Color::White, SCREEN_HEIGHT / 2 + 120);
     
-    // Win message if player won
-    if (playerWon) {
-        winText.setFont(font);
-        winText.setString("You Won!");
-        winText.setCharacterSize(40);
-        winText.setFillColor(sf::Color::Yellow);
-        winText.setPosition(
-            SCREEN_WIDTH / 2 - winText.getGlobalBounds().width / 2,
-            SCREEN_HEIGHT / 4 + 80
-        );
+    // High score table; the score lines are filled in by layoutHighScoreTexts
+    layoutText(TEXT_HIGH_SCORES_TITLE, font, "HIGH SCORES", 50, sf::Color::Green, SCREEN_HEIGHT / 6);
+    layoutText(TEXT_HIGH_SCORES_BACK, font, "Press ESC to return to menu", 24, sf::Color::Yellow, SCREEN_HEIGHT * 3 / 4);
+    for (int i = 0; i < MAX_HIGH_SCORES; i++) {
+        layoutText(TEXT_HIGH_SCORE_LINES + i, font, "", 36, sf::Color::White, SCREEN_HEIGHT / 3 + i * 50);
     }
     
-    // Play option
-    playText.setFont(font);
-    playText.setString("Play Game");
-    playText.setCharacterSize(36);
-    playText.setFillColor(selectedMenuItem == MENU_PLAY ? sf::Color::Yellow : sf::Color::White);
-    playText.setPosition(
-        SCREEN_WIDTH / 2 - playText.getGlobalBounds().width / 2,
-        SCREEN_HEIGHT / 2
-    );
-    if (selectedMenuItem == MENU_PLAY) {
-        playText.setScale(1.1f, 1.1f); // Hover effect
-    } else {
-        playText.setScale(1.0f, 1.0f);
-    }
+    // Pause overlay, centered both ways
+    layoutText(TEXT_PAUSED, font, "PAUSED", 50, sf::Color::White, 0);
+    sf::Text& paused = screenTexts[TEXT_PAUSED];
+    paused.setPosition(paused.getPosition().x, SCREEN_HEIGHT / 2 - paused.getGlobalBounds().height / 2);
+    layoutText(TEXT_WAITING, font, "Waiting for the other player", 30, sf::Color::White, SCREEN_HEIGHT / 2);
     
-    // High scores option
-    scoresText.setFont(font);
-    scoresText.setString("High Scores");
-    scoresText.setCharacterSize(36);
-    scoresText.setFillColor(selectedMenuItem == MENU_HIGH_SCORES ? sf::Color::Yellow : sf::Color::White);
-    scoresText.setPosition(
-        SCREEN_WIDTH / 2 - scoresText.getGlobalBounds().width / 2,
-        SCREEN_HEIGHT / 2 + 60
-    );
-    if (selectedMenuItem == MENU_HIGH_SCORES) {
-        scoresText.setScale(1.1f, 1.1f); // Hover effect
-    } else {
-        scoresText.setScale(1.0f, 1.0f);
+    // Load every glyph the score can use now rather than on the frame it first shows up
+    for (const char* c = SCORE_LABEL; *c; ++c) {
+        font.getGlyph(*c, SCORE_CHARACTER_SIZE, false);
     }
-    
-    // Exit option
-    exitText.setFont(font);
-    exitText.setString("Exit");
-    exitText.setCharacterSize(36);
-    exitText.setFillColor(selectedMenuItem == MENU_EXIT ? sf::Color::Yellow : sf::Color::White);
-    exitText.setPosition(
-        SCREEN_WIDTH / 2 - exitText.getGlobalBounds().width / 2,
-        SCREEN_HEIGHT / 2 + 120
-    );
-    if (selectedMenuItem == MENU_EXIT) {
-        exitText.setScale(1.1f, 1.1f); // Hover effect
-    } else {
-        exitText.setScale(1.0f, 1.0f);
+    for (char c = '0'; c <= '9'; ++c) {
+        font.getGlyph(c, SCORE_CHARACTER_SIZE, false);
     }
-    
-    window.draw(titleText);
-    if (playerWon) window.draw(winText);
-    window.draw(playText);
-    window.draw(scoresText);
-    window.draw(exitText);
 }
 
-void drawGameOverMenu(sf::RenderWindow& window, sf::Font& font) {
-    sf::Text titleText, mainMenuText, restartText, leaderboardText;
-    
-    // Title
-    titleText.setFont(font);
-    titleText.setString("GAME OVER");
-    titleText.setCharacterSize(60);
-    titleText.setFillColor(sf::Color::Red);
-    titleText.setPosition(
-        SCREEN_WIDTH / 2 - titleText.getGlobalBounds().width / 2,
-        SCREEN_HEIGHT / 4
-    );
-    
-    // Main Menu option
-    mainMenuText.setFont(font);
-    mainMenuText.setString("Return to Main Menu");
-    mainMenuText.setCharacterSize(36);
-    mainMenuText.setFillColor(selectedMenuItem == GAME_OVER_MAIN_MENU ? sf::Color::Yellow : sf::Color::White);
-    mainMenuText.setPosition(
-        SCREEN_WIDTH / 2 - mainMenuText.getGlobalBounds().width / 2,
-        SCREEN_HEIGHT / 2
-    );
-    if (selectedMenuItem == GAME_OVER_MAIN_MENU) {
-        mainMenuText.setScale(1.1f, 1.1f); // Hover effect
-    } else {
-        mainMenuText.setScale(1.0f, 1.0f);
+// Only runs when the table changes, never per frame
+void layoutHighScoreTexts() {
+    for (int i = 0; i < MAX_HIGH_SCORES; i++) {
+        sf::Text& line = screenTexts[TEXT_HIGH_SCORE_LINES + i];
+        line.setString(std::to_string(i + 1) + ". " + std::to_string(highScores[i]));
+        line.setPosition(SCREEN_WIDTH / 2 - line.getGlobalBounds().width / 2, line.getPosition().y);
     }
+}
+
+void renderScore(sf::RenderTarget& target, sf::Font& font) {
+    char text[MAX_SCORE_CHARS];
+    int length = snprintf(text, sizeof(text), "%s%d", SCORE_LABEL, score);
+    if (length > MAX_SCORE_CHARS - 1) length = MAX_SCORE_CHARS - 1;
     
-    // Restart option
-    restartText.setFont(font);
-    restartText.setString("Restart");
-    restartText.setCharacterSize(36);
-    restartText.setFillColor(selectedMenuItem == GAME_OVER_RESTART ? sf::Color::Yellow : sf::Color::White);
-    restartText.setPosition(
-        SCREEN_WIDTH / 2 - restartText.getGlobalBounds().width / 2,
-        SCREEN_HEIGHT / 2 + 60
-    );
-    if (selectedMenuItem == GAME_OVER_RESTART) {
-        restartText.setScale(1.1f, 1.1f); // Hover effect
-    } else {
-        restartText.setScale(1.0f, 1.0f);
+    // Same placement as an sf::Text at (10, 10): the baseline is one character size down
+    float x = 10.0f;
+    float baseline = 10.0f + SCORE_CHARACTER_SIZE;
+    sf::Uint32 previous = 0;
+    for (int i = 0; i < length; ++i) {
+        sf::Uint32 c = static_cast<unsigned char>(text[i]);
+        x += font.getKerning(previous, c, SCORE_CHARACTER_SIZE);
+        previous = c;
+        const sf::Glyph& glyph = font.getGlyph(c, SCORE_CHARACTER_SIZE, false);
+        
+        float left = x + glyph.bounds.left;
+        float top = baseline + glyph.bounds.top;
+        float right = left + glyph.bounds.width;
+        float bottom = top + glyph.bounds.height;
+        float u = glyph.textureRect.left, v = glyph.textureRect.top;
+        float u2 = u + glyph.textureRect.width, v2 = v + glyph.textureRect.height;
+        sf::Vertex* quad = &scoreVertices[i * 4];
+        quad[0] = sf::Vertex(sf::Vector2f(left, top), sf::Color::Green, sf::Vector2f(u, v));
+        quad[1] = sf::Vertex(sf::Vector2f(right, top), sf::Color::Green, sf::Vector2f(u2, v));
+        quad[2] = sf::Vertex(sf::Vector2f(right, bottom), sf::Color::Green, sf::Vector2f(u2, v2));
+        quad[3] = sf::Vertex(sf::Vector2f(left, bottom), sf::Color::Green, sf::Vector2f(u, v2));
+        x += glyph.advance;
     }
     
-    // Leaderboard option
-    leaderboardText.setFont(font);
-    leaderboardText.setString("View Leaderboard");
-    leaderboardText.setCharacterSize(36);
-    leaderboardText.setFillColor(selectedMenuItem == GAME_OVER_LEADERBOARD ? sf::Color::Yellow : sf::Color::White);
-    leaderboardText.setPosition(
-        SCREEN_WIDTH / 2 - leaderboardText.getGlobalBounds().width / 2,
-        SCREEN_HEIGHT / 2 + 120
-    );
-    if (selectedMenuItem == GAME_OVER_LEADERBOARD) {
-        leaderboardText.setScale(1.1f, 1.1f); // Hover effect
-    } else {
-        leaderboardText.setScale(1.0f, 1.0f);
-    }
+    target.draw(scoreVertices, length * 4, sf::Quads, sf::RenderStates(&font.getTexture(SCORE_CHARACTER_SIZE)));
+    addMetric(METRIC_DRAW_CALLS, 1);
+}
+
+void drawMenu(sf::RenderTarget& target) {
+    highlightText(TEXT_MENU_PLAY, selectedMenuItem == MENU_PLAY);
+    highlightText(TEXT_MENU_HIGH_SCORES, selectedMenuItem == MENU_HIGH_SCORES);
+    highlightText(TEXT_MENU_EXIT, selectedMenuItem == MENU_EXIT);
+    
+    target.draw(screenTexts[TEXT_MENU_TITLE]);
+    if (playerWon) target.draw(screenTexts[TEXT_MENU_WIN]);
+    target.draw(screenTexts[TEXT_MENU_PLAY]);
+    target.draw(screenTexts[TEXT_MENU_HIGH_SCORES]);
+    target.draw(screenTexts[TEXT_MENU_EXIT]);
+    addMetric(METRIC_DRAW_CALLS, playerWon ? 5 : 4);
+}
+
+void drawGameOverMenu(sf::RenderTarget& target) {
+    highlightText(TEXT_GAME_OVER_MAIN_MENU, selectedMenuItem == GAME_OVER_MAIN_MENU);
+    highlightText(TEXT_GAME_OVER_RESTART, selectedMenuItem == GAME_OVER_RESTART);
+    highlightText(TEXT_GAME_OVER_LEADERBOARD, selectedMenuItem == GAME_OVER_LEADERBOARD);
     
-    window.draw(titleText);
-    window.draw(mainMenuText);
-    window.draw(restartText);
-    window.draw(leaderboardText);
+    target.draw(screenTexts[TEXT_GAME_OVER_TITLE]);
+    target.draw(screenTexts[TEXT_GAME_OVER_MAIN_MENU]);
+    target.draw(screenTexts[TEXT_GAME_OVER_RESTART]);
+    target.draw(screenTexts[TEXT_GAME_OVER_LEADERBOARD]);
+    addMetric(METRIC_DRAW_CALLS, 4);
 }
 
 void handleMenuInput(sf::Event& event, sf::RenderWindow& window) {
@@ -793,6 +1082,7 @@ void handleMenuInput(sf::Event& event, sf::RenderWindow& window) {
 void saveHighScores() {
     std::ofstream file(HIGH_SCORE_FILE);
     if (file.is_open()) {
+        addMetric(METRIC_HIGH_SCORE_WRITES, 1);
         for (int i = 0; i < MAX_HIGH_SCORES; i++) {
             file << highScores[i] << std::endl;
         }
@@ -810,6 +1100,7 @@ void loadHighScores() {
         }
         file.close();
     }
+    layoutHighScoreTexts();
 }
 
 void updateHighScores(int newScore) {
@@ -831,373 +1122,145 @@ void updateHighScores(int newScore) {
         // Insert new score
         highScores[position] = newScore;
         saveHighScores();
+        layoutHighScoreTexts();
     }
 }
 
-void drawHighScores(sf::RenderWindow& window, sf::Font& font) {
-    sf::Text titleText, scoreText, backText;
-    
-    // Title
-    titleText.setFont(font);
-    titleText.setString("HIGH SCORES");
-    titleText.setCharacterSize(50);
-    titleText.setFillColor(sf::Color::Green);
-    titleText.setPosition(
-        SCREEN_WIDTH / 2 - titleText.getGlobalBounds().width / 2,
-        SCREEN_HEIGHT / 6
-    );
-    
-    window.draw(titleText);
-    
-    // Scores
+void drawHighScores(sf::RenderTarget& target) {
+    target.draw(screenTexts[TEXT_HIGH_SCORES_TITLE]);
     for (int i = 0; i < MAX_HIGH_SCORES; i++) {
-        scoreText.setFont(font);
-        scoreText.setString(std::to_string(i + 1) + ". " + std::to_string(highScores[i]));
-        scoreText.setCharacterSize(36);
-        scoreText.setFillColor(sf::Color::White);
-        scoreText.setPosition(
-            SCREEN_WIDTH / 2 - scoreText.getGlobalBounds().width / 2,
-            SCREEN_HEIGHT / 3 + i * 50
-        );
-        window.draw(scoreText);
+        target.draw(screenTexts[TEXT_HIGH_SCORE_LINES + i]);
     }
-    
-    // Back instruction
-    backText.setFont(font);
-    backText.setString("Press ESC to return to menu");
-    backText.setCharacterSize(24);
-    backText.setFillColor(sf::Color::Yellow);
-    backText.setPosition(
-        SCREEN_WIDTH / 2 - backText.getGlobalBounds().width / 2,
-        SCREEN_HEIGHT * 3 / 4
-    );
-    window.draw(backText);
+    target.draw(screenTexts[TEXT_HIGH_SCORES_BACK]);
+    addMetric(METRIC_DRAW_CALLS, MAX_HIGH_SCORES + 2);
 }
 
-void splitCentipede(int hitSegmentIndex) {
-    int hitX = centipedeGrid[hitSegmentIndex][X];
-    int hitY = centipedeGrid[hitSegmentIndex][Y];
-    int hitGroup = centipedeGroup[hitSegmentIndex];
-
-    // Create poisonous mushroom at hit position
-    bool mushroomCreated = false;
-    for (int i = 0; i < NUM_MUSHROOMS; i++) {
-        if (!mushroomGrid[i][EXISTS]) {
-            mushroomGrid[i][X] = hitX;
-            mushroomGrid[i][Y] = hitY;
-            mushroomGrid[i][EXISTS] = true;
-            mushroomGrid[i][DAMAGE] = 0;
-            mushroomGrid[i][IS_POISONOUS] = true; // Mark as poisonous
-            mushroomCreated = true;
-            break;
-        }
-    }
-
-    // Award points: more for head, less for body
-    bool isHead = false;
-    if (groupMoveLeft[hitGroup]) {
-        int minX = SCREEN_WIDTH;
-        int headIndex = -1;
-        for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
-            if (centipedeGrid[i][EXISTS] && centipedeGroup[i] == hitGroup && centipedeGrid[i][X] < minX) {
-                minX = centipedeGrid[i][X];
-                headIndex = i;
-            }
-        }
-        isHead = (hitSegmentIndex == headIndex);
-    } else {
-        int maxX = -1;
-        int headIndex = -1;
-        for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
-            if (centipedeGrid[i][EXISTS] && centipedeGroup[i] == hitGroup && centipedeGrid[i][X] > maxX) {
-                maxX = centipedeGrid[i][X];
-                headIndex = i;
-            }
-        }
-        isHead = (hitSegmentIndex == headIndex);
-    }
-    score += isHead ? 100 : 10;
-
-    // Mark hit segment as non-existent
-    centipedeGrid[hitSegmentIndex][EXISTS] = false;
-
-    // Check for segments to the left and right of the hit segment
-    bool hasLeftSegments = false;
-    bool hasRightSegments = false;
-    for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
-        if (centipedeGrid[i][EXISTS] && centipedeGroup[i] == hitGroup) {
-            if ((groupMoveLeft[hitGroup] && centipedeGrid[i][X] < hitX) ||
-                (!groupMoveLeft[hitGroup] && centipedeGrid[i][X] > hitX)) {
-                hasLeftSegments = true;
+// Every tile steps on the spectator pool; the window only polls events and
+// issues the batched draws
+void runSpectatorLoop(sf::RenderWindow& window, sf::Sprite& backgroundSprite) {
+    sf::Clock frameClock;
+    long long tickAccumulator = 0; // Real time not yet simulated, in microseconds
+    while (window.isOpen()) {
+        sf::Event event;
+        while (window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed ||
+                (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape)) {
+                window.close();
             }
-            if ((groupMoveLeft[hitGroup] && centipedeGrid[i][X] > hitX) ||
-                (!groupMoveLeft[hitGroup] && centipedeGrid[i][X] < hitX)) {
-                hasRightSegments = true;
+            if (event.type == sf::Event::Resized) {
+                resizeDisplay(window);
             }
         }
-    }
-
-    // If there are right segments, create a new group for them
-    if (hasRightSegments && groupCount < MAX_GROUPS) {
-        int newGroup = groupCount++;
-        groupMoveLeft[newGroup] = !groupMoveLeft[hitGroup];
-        groupInPlayerArea[newGroup] = groupInPlayerArea[hitGroup]; // Inherit player area status
-        for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
-            if (centipedeGrid[i][EXISTS] && centipedeGroup[i] == hitGroup) {
-                if ((groupMoveLeft[hitGroup] && centipedeGrid[i][X] > hitX) ||
-                    (!groupMoveLeft[hitGroup] && centipedeGrid[i][X] < hitX)) {
-                    centipedeGroup[i] = newGroup;
-                    if (groupInPlayerArea[newGroup]) {
-                        int currentRow = centipedeGrid[i][Y] / TILE_SIZE;
-                        int nextRow = currentRow + 1;
-                        if (nextRow > GRID_ROWS - 1) {
-                            nextRow = GRID_ROWS - MAX_PLAYER_ROWS; // Wrap to top of player area
-                        }
-                        centipedeGrid[i][Y] = nextRow * TILE_SIZE;
-                    } else {
-                        centipedeGrid[i][Y] += TILE_SIZE;
-                    }
-                }
-            }
-        }
-    }
-}
-
-void spawnNewHead() {
-    // Find an unused segment slot
-    int newSegmentIndex = -1;
-    for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
-        if (!centipedeGrid[i][EXISTS]) {
-            newSegmentIndex = i;
-            break;
+        if (!window.isOpen()) break;
+        long long frameMicros = frameClock.restart().asMicroseconds();
+        beginFlightFrame();
+        beginAllocationFrame();
+        markPhase(PHASE_EVENTS);
+        
+        tickAccumulator += frameMicros;
+        int ticksRun = static_cast<int>(min(tickAccumulator / MICROS_PER_TICK, static_cast<long long>(MAX_TICKS_PER_FRAME)));
+        if (ticksRun == MAX_TICKS_PER_FRAME) {
+            tickAccumulator = 0; // After a longer stall the lost time is dropped
+        } else {
+            tickAccumulator -= ticksRun * MICROS_PER_TICK;
         }
+        stepSpectator(ticksRun);
+        addMetric(METRIC_TICKS, ticksRun);
+        markPhase(PHASE_SIMULATION);
+        
+        addMetric(METRIC_FRAMES, 1);
+        observeHistogram(HISTOGRAM_FRAME_TIME, frameMicros * 1000);
+        sf::RenderTarget& target = beginFrame(window);
+        target.draw(backgroundSprite);
+        drawSpectator(target);
+        addMetric(METRIC_DRAW_CALLS, 4);
+        markPhase(PHASE_DRAW);
+        
+        endFrame(window);
+        markPhase(PHASE_DISPLAY);
+        endFlightFrame(ticksRun, playerInput);
+        endAllocationFrame();
     }
-    if (newSegmentIndex == -1 || groupCount >= MAX_GROUPS) return; // No space or too many groups
-
-    // Create new group for the head
-    int newGroup = groupCount++;
-    groupInPlayerArea[newGroup] = true; // Head spawns in player area
-    groupMoveLeft[newGroup] = rand() % 2; // Random direction (true = left, false = right)
-
-    // Set position in player area (rows 25-29)
-    int newRow = (rand() % MAX_PLAYER_ROWS) + (GRID_ROWS - MAX_PLAYER_ROWS);
-    centipedeGrid[newSegmentIndex][Y] = newRow * TILE_SIZE;
-    centipedeGrid[newSegmentIndex][X] = groupMoveLeft[newGroup] ? SCREEN_WIDTH : -TILE_SIZE;
-    centipedeGrid[newSegmentIndex][EXISTS] = true;
-    centipedeGroup[newSegmentIndex] = newGroup;
 }
 
-void checkBulletCentipedeCollisions() {
-    if (!bullet[EXISTS]) return;
+int runHeadless(long long maxTicks) {
+    long long tick = 0;
+    int gamesPlayed = 0;
+    double simMicros = 0.0, simMicrosMax = 0.0, planMicros = 0.0;
     
-    for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
-        if (centipedeGrid[i][EXISTS]) {
-            if (checkCollision(
-                bullet[X], bullet[Y], TILE_SIZE, TILE_SIZE,
-                centipedeGrid[i][X], centipedeGrid[i][Y], TILE_SIZE, TILE_SIZE)) {
-                
-                // Spawn poisonous mushroom at hit position
-                bool mushroomCreated = false;
-                for (int j = 0; j < NUM_MUSHROOMS; j++) {
-                    if (!mushroomGrid[j][EXISTS]) {
-                        mushroomGrid[j][X] = centipedeGrid[i][X];
-                        mushroomGrid[j][Y] = centipedeGrid[i][Y];
-                        mushroomGrid[j][EXISTS] = true;
-                        mushroomGrid[j][DAMAGE] = 0;
-                        mushroomGrid[j][IS_POISONOUS] = true;
-                        mushroomCreated = true;
-                        break;
-                    }
-                }
-                
-                // Split the centipede
-                splitCentipede(i);
-                
-                // Reset bullet
-                bullet[EXISTS] = false;
-
-                // Check if all segments are eliminated
-                bool allEliminated = true;
-                for (int j = 0; j < CENTIPEDE_LENGTH; ++j) {
-                    if (centipedeGrid[j][EXISTS]) {
-                        allEliminated = false;
-                        break;
-                    }
-                }
-                if (allEliminated) {
-                    updateHighScores(score);
-                    currentGameState = MENU_STATE;
-                    playerWon = true;
-                }
-                return;
-            }
-        }
-    }
-}
-
-void moveCentipede(float deltaTime) {
-    int moveStep = 3; // Speed multiplier
-
-    for (int group = 0; group < groupCount; ++group) {
-        // Find head for the current group
-        int headIndex = -1;
-        if (groupMoveLeft[group]) {
-            int minX = SCREEN_WIDTH;
-            for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
-                if (centipedeGrid[i][EXISTS] && centipedeGroup[i] == group && centipedeGrid[i][X] < minX) {
-                    minX = centipedeGrid[i][X];
-                    headIndex = i;
-                }
-            }
+    currentGameState = GAME_STATE;
+    resetGame();
+    
+    while (maxTicks == 0 || tick < maxTicks) {
+        chrono::steady_clock::time_point planStart = chrono::steady_clock::now();
+        beginFlightFrame(planStart);
+        beginAllocationFrame();
+        if (autopilotEnabled) {
+            chooseAutopilotInput(playerInput);
         } else {
-            int maxX = -1;
-            for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
-                if (centipedeGrid[i][EXISTS] && centipedeGroup[i] == group && centipedeGrid[i][X] > maxX) {
-                    maxX = centipedeGrid[i][X];
-                    headIndex = i;
-                }
-            }
+            memset(playerInput, 0, sizeof(playerInput)); // Idle player
         }
-
-        // Check if group is entering player area
-        if (!groupInPlayerArea[group] && headIndex != -1 && centipedeGrid[headIndex][Y] >= (GRID_ROWS - MAX_PLAYER_ROWS) * TILE_SIZE) {
-            groupInPlayerArea[group] = true;
-            // Spawn poisonous mushroom at head position
-            bool mushroomCreated = false;
-            for (int i = 0; i < NUM_MUSHROOMS; i++) {
-                if (!mushroomGrid[i][EXISTS]) {
-                    mushroomGrid[i][X] = centipedeGrid[headIndex][X];
-                    mushroomGrid[i][Y] = centipedeGrid[headIndex][Y];
-                    mushroomGrid[i][EXISTS] = true;
-                    mushroomGrid[i][DAMAGE] = 0;
-                    mushroomGrid[i][IS_POISONOUS] = true;
-                    mushroomCreated = true;
-                    break;
-                }
-            }
+        applyTuningUpdate();
+        unsigned long long checksBefore = collisionChecks;
+        chrono::steady_clock::time_point simStart = chrono::steady_clock::now();
+        int outcome = updateGame(playerInput);
+        if (isArenaActive()) {
+            outcome = updateArena(playerInput, outcome);
         }
-
-        // Handle movement (rest of the function remains the same)
-        if (groupInPlayerArea[group]) {
-            // In player area: move horizontally, reverse on collision or screen edge
-            bool mushroomCollision = false;
-            bool edgeCollision = false;
-            if (headIndex != -1) {
-                int nextX = centipedeGrid[headIndex][X] + (groupMoveLeft[group] ? -moveStep : moveStep);
-                // Check for mushroom collision
-                for (int i = 0; i < NUM_MUSHROOMS; ++i) {
-                    if (mushroomGrid[i][EXISTS]) {
-                        if (checkCollision(
-                            nextX, centipedeGrid[headIndex][Y], TILE_SIZE, TILE_SIZE,
-                            mushroomGrid[i][X], mushroomGrid[i][Y], TILE_SIZE, TILE_SIZE)) {
-                            mushroomCollision = true;
-                            break;
-                        }
-                    }
-                }
-                // Check for screen edge collision
-                if (groupMoveLeft[group] && nextX < 0) {
-                    edgeCollision = true;
-                } else if (!groupMoveLeft[group] && nextX + TILE_SIZE > SCREEN_WIDTH) {
-                    edgeCollision = true;
-                }
-            }
-
-            if (mushroomCollision || edgeCollision) {
-                groupMoveLeft[group] = !groupMoveLeft[group];
-                // Move all segments to the next row in the player area
-                for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
-                    if (centipedeGrid[i][EXISTS] && centipedeGroup[i] == group) {
-                        int currentRow = centipedeGrid[i][Y] / TILE_SIZE;
-                        int nextRow = currentRow + (groupMoveLeft[group] ? 1 : 1);
-                        if (nextRow > GRID_ROWS - 1) {
-                            nextRow = GRID_ROWS - MAX_PLAYER_ROWS;
-                        }
-                        centipedeGrid[i][Y] = nextRow * TILE_SIZE;
-                    }
-                }
-            } else {
-                // Normal horizontal movement
-                for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
-                    if (centipedeGrid[i][EXISTS] && centipedeGroup[i] == group) {
-                        centipedeGrid[i][X] += groupMoveLeft[group] ? -moveStep : moveStep;
-                    }
-                }
-            }
-        } else {
-            // Normal movement outside player area
-            bool shouldChangeDirection = false;
-            int tailIndex = -1;
-            if (groupMoveLeft[group]) {
-                int maxX = -SCREEN_WIDTH;
-                for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
-                    if (centipedeGrid[i][EXISTS] && centipedeGroup[i] == group && centipedeGrid[i][X] > maxX) {
-                        maxX = centipedeGrid[i][X];
-                        tailIndex = i;
-                    }
-                }
-                if (tailIndex != -1 && centipedeGrid[tailIndex][X] + TILE_SIZE < 0) {
-                    shouldChangeDirection = true;
-                }
-            } else {
-                int minX = SCREEN_WIDTH * 2;
-                for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
-                    if (centipedeGrid[i][EXISTS] && centipedeGroup[i] == group && centipedeGrid[i][X] < minX) {
-                        minX = centipedeGrid[i][X];
-                        tailIndex = i;
-                    }
-                }
-                if (tailIndex != -1 && centipedeGrid[tailIndex][X] > SCREEN_WIDTH) {
-                    shouldChangeDirection = true;
-                }
+        chrono::steady_clock::time_point simEnd = chrono::steady_clock::now();
+        recordTick(playerInput);
+        recordTickMetrics(chrono::duration_cast<chrono::nanoseconds>(simEnd - simStart).count(),
+                          collisionChecks - checksBefore, outcome);
+        
+        double tickMicros = chrono::duration<double, micro>(simEnd - simStart).count();
+        simMicros += tickMicros;
+        if (tickMicros > simMicrosMax) simMicrosMax = tickMicros;
+        planMicros += chrono::duration<double, micro>(simStart - planStart).count();
+        ++tick;
+        
+        // Headless, every tick is its own flight record frame
+        long long tickNanos = chrono::duration_cast<chrono::nanoseconds>(simEnd - simStart).count();
+        addPhaseTime(PHASE_INPUT, chrono::duration_cast<chrono::nanoseconds>(simStart - planStart).count());
+        addPhaseTime(PHASE_SIMULATION, tickNanos);
+        noteTickTime(tickNanos);
+        endFlightFrame(1, playerInput);
+        endAllocationFrame();
+        
+        if (outcome != TICK_RUNNING) {
+            ++gamesPlayed;
+            cout << "game " << gamesPlayed << (outcome == TICK_PLAYER_WON ? " won" : " lost")
+                 << " at tick " << tick << " with score " << score << endl;
+            resetGame();
+        }
+        
+        if (tick % TICKS_PER_SECOND == 0) {
+            updateWorldGauges();
+        }
+        
+        // Periodic report so slowdowns and state growth deep into a session show up
+        if (tick % HEADLESS_REPORT_TICKS == 0) {
+            int liveSegments = 0, liveMushrooms = 0;
+            for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
+                if (centipedeGrid[i][EXISTS]) liveSegments++;
             }
-
-            if (shouldChangeDirection) {
-                groupMoveLeft[group] = !groupMoveLeft[group];
-                for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
-                    if (centipedeGrid[i][EXISTS] && centipedeGroup[i] == group) {
-                        centipedeGrid[i][Y] += TILE_SIZE;
-                        if (groupMoveLeft[group]) {
-                            centipedeGrid[i][X] = SCREEN_WIDTH + (CENTIPEDE_LENGTH - i - 1) * TILE_SIZE;
-                        } else {
-                            centipedeGrid[i][X] = -(CENTIPEDE_LENGTH - i) * TILE_SIZE;
-                        }
-                    }
-                }
-            } else {
-                if (groupMoveLeft[group]) {
-                    for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
-                        if (centipedeGrid[i][EXISTS] && centipedeGroup[i] == group) {
-                            centipedeGrid[i][X] -= moveStep;
-                        }
-                    }
-                } else {
-                    for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
-                        if (centipedeGrid[i][EXISTS] && centipedeGroup[i] == group) {
-                            centipedeGrid[i][X] += moveStep;
-                        }
-                    }
-                }
+            for (int i = 0; i < NUM_MUSHROOMS; ++i) {
+                if (mushroomGrid[i][EXISTS]) liveMushrooms++;
             }
-
-            // Handle mushroom collisions with the head
-            if (headIndex != -1) {
-                for (int i = 0; i < NUM_MUSHROOMS; ++i) {
-                    if (mushroomGrid[i][EXISTS]) {
-                        if (checkCollision(
-                            centipedeGrid[headIndex][X], centipedeGrid[headIndex][Y], TILE_SIZE, TILE_SIZE,
-                            mushroomGrid[i][X], mushroomGrid[i][Y], TILE_SIZE, TILE_SIZE)) {
-                            groupMoveLeft[group] = !groupMoveLeft[group];
-                            for (int j = 0; j < CENTIPEDE_LENGTH; ++j) {
-                                if (centipedeGrid[j][EXISTS] && centipedeGroup[j] == group) {
-                                    centipedeGrid[j][Y] += TILE_SIZE;
-                                }
-                            }
-                            break;
-                        }
-                    }
-                }
+            cout << "tick " << tick << " games " << gamesPlayed << " score " << score
+                 << " groups " << groupCount << " segments " << liveSegments
+                 << " mushrooms " << liveMushrooms;
+            if (isArenaActive()) {
+                cout << " chunk " << arenaChunkX() << "," << arenaChunkY()
+                     << " resident " << arenaResidentChunks();
             }
+            cout << " hash " << hex << worldHashTotal() << dec
+                 << " sim avg " << simMicros / HEADLESS_REPORT_TICKS << " us"
+                 << " max " << simMicrosMax << " us"
+                 << " plan avg " << planMicros / HEADLESS_REPORT_TICKS << " us" << endl;
+            simMicros = 0.0;
+            simMicrosMax = 0.0;
+            planMicros = 0.0;
         }
     }
-}
\ No newline at end of file
+    return 0;
+}
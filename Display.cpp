@@ -0,0 +1,79 @@
+#include "Display.h"
+#include "Simulation.h"
+#include "Capture.h"
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+
+sf::View gameView(sf::FloatRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT));
+sf::RenderTexture internalTarget;
+sf::Sprite internalSprite;
+int internalTargetSize = 0;
+
+bool setupDisplay(sf::RenderWindow& window, int internalSize) {
+    internalTargetSize = internalSize;
+    if (internalTargetSize > 0) {
+        if (!internalTarget.create(internalTargetSize, internalTargetSize)) {
+            std::cerr << "Failed to create " << internalTargetSize << "x" << internalTargetSize
+                      << " render texture!" << std::endl;
+            return false;
+        }
+        internalTarget.setSmooth(false); // Nearest filtering keeps the pixel art crisp
+        internalTarget.setView(gameView);
+        internalSprite.setTexture(internalTarget.getTexture(), true);
+    }
+    resizeDisplay(window);
+    return true;
+}
+
+void resizeDisplay(sf::RenderWindow& window) {
+    float width = static_cast<float>(max(window.getSize().x, 1u));
+    float height = static_cast<float>(max(window.getSize().y, 1u));
+    float side = min(width, height);
+    
+    if (internalTargetSize > 0) {
+        // Window pixels map one to one; the internal image is scaled and centered
+        window.setView(sf::View(sf::FloatRect(0, 0, width, height)));
+        float scale = side / internalTargetSize;
+        if (scale >= 1.0f) scale = static_cast<float>(static_cast<int>(scale)); // Whole factors only
+        float drawnSide = internalTargetSize * scale;
+        internalSprite.setScale(scale, scale);
+        internalSprite.setPosition(static_cast<int>((width - drawnSide) / 2), static_cast<int>((height - drawnSide) / 2));
+    } else {
+        // Letterbox the square game space in the middle of the window
+        gameView.setViewport(sf::FloatRect((width - side) / 2 / width, (height - side) / 2 / height,
+                                           side / width, side / height));
+        window.setView(gameView);
+    }
+}
+
+sf::RenderTarget& beginFrame(sf::RenderWindow& window) {
+    window.clear();
+    if (internalTargetSize > 0) {
+        internalTarget.clear();
+        return internalTarget;
+    }
+    return window;
+}
+
+// The game square in window pixels
+static sf::IntRect gameRegion(sf::RenderWindow& window) {
+    if (internalTargetSize > 0) {
+        sf::FloatRect bounds = internalSprite.getGlobalBounds();
+        return sf::IntRect(static_cast<int>(bounds.left), static_cast<int>(bounds.top),
+                           static_cast<int>(bounds.width), static_cast<int>(bounds.height));
+    }
+    return window.getViewport(gameView);
+}
+
+void endFrame(sf::RenderWindow& window) {
+    if (internalTargetSize > 0) {
+        internalTarget.display();
+        window.draw(internalSprite);
+    }
+    if (isCapturing()) {
+        captureFrame(window, gameRegion(window));
+    }
+    window.display();
+}
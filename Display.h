@@ -0,0 +1,18 @@
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+#include <SFML/Graphics.hpp>
+
+// Maps the logical SCREEN_WIDTH x SCREEN_HEIGHT game space onto the real
+// window. The game is drawn either straight to the window through a
+// letterboxed view, or into a smaller square texture (internalSize pixels a
+// side) that is then scaled up with nearest filtering, by a whole factor
+// whenever the window is large enough.
+
+// internalSize 0 draws straight to the window
+bool setupDisplay(sf::RenderWindow& window, int internalSize);
+void resizeDisplay(sf::RenderWindow& window); // Call on sf::Event::Resized
+sf::RenderTarget& beginFrame(sf::RenderWindow& window); // Target to draw the frame on
+void endFrame(sf::RenderWindow& window); // Upscales if needed, hands the frame to Capture and displays
+
+#endif
@@ -0,0 +1,190 @@
+#include "Effects.h"
+#include "Metrics.h"
+#include <iostream>
+#include <cmath>
+
+using namespace std;
+
+// Atlas layout: explosion.png (six 32x32 frames) on top, death.png (two rows
+// of eight 32x32 frames) below it
+const int EFFECT_FRAME_SIZE = 32;
+const int EXPLOSION_FRAMES = 6;
+const int DEATH_FRAMES = 16;
+const int DEATH_SHEET_COLUMNS = 8;
+const int DEATH_SHEET_Y = 32;
+const int ATLAS_WIDTH = 256;
+const int ATLAS_HEIGHT = 96;
+const int MAX_EFFECT_FRAMES = DEATH_FRAMES;
+
+const float DEBRIS_GRAVITY = 600.0f; // Pixels per second squared
+
+sf::Texture effectAtlas;
+
+// Frame tables, filled once at load
+sf::Vector2f effectFrames[NUM_EFFECTS][MAX_EFFECT_FRAMES]; // Top-left texel of each frame
+int effectFrameCount[NUM_EFFECTS];
+float effectTexelSize[NUM_EFFECTS]; // Side of the frame in the atlas
+float effectDrawSize[NUM_EFFECTS]; // Side of the quad on screen
+float effectLifetime[NUM_EFFECTS]; // Seconds
+bool effectFades[NUM_EFFECTS];
+
+// Particle pool, one array per field; live particles are [0, particleCount)
+float particleX[MAX_PARTICLES];
+float particleY[MAX_PARTICLES];
+float particleVX[MAX_PARTICLES];
+float particleVY[MAX_PARTICLES];
+float particleFall[MAX_PARTICLES]; // Downward acceleration
+float particleAge[MAX_PARTICLES];
+float particleLife[MAX_PARTICLES];
+int particleKind[MAX_PARTICLES];
+int particleCount = 0;
+
+sf::Vertex particleVertices[MAX_PARTICLES * 4];
+
+// Separate from the simulation's generator so effects never change a game
+unsigned int effectRandomState = 2463534242u;
+
+static float effectRandom() {
+    effectRandomState ^= effectRandomState << 13;
+    effectRandomState ^= effectRandomState >> 17;
+    effectRandomState ^= effectRandomState << 5;
+    return (effectRandomState >> 8) * (1.0f / 16777216.0f); // [0, 1)
+}
+
+bool loadEffects() {
+    sf::Image explosionImage, deathImage, atlasImage;
+    if (!explosionImage.loadFromFile("Textures/explosion.png")) {
+        std::cerr << "Failed to load explosion texture!" << std::endl;
+        return false;
+    }
+    if (!deathImage.loadFromFile("Textures/death.png")) {
+        std::cerr << "Failed to load death texture!" << std::endl;
+        return false;
+    }
+    atlasImage.create(ATLAS_WIDTH, ATLAS_HEIGHT, sf::Color::Transparent);
+    atlasImage.copy(explosionImage, 0, 0);
+    atlasImage.copy(deathImage, 0, DEATH_SHEET_Y);
+    if (!effectAtlas.loadFromImage(atlasImage)) {
+        std::cerr << "Failed to build effect atlas!" << std::endl;
+        return false;
+    }
+
+    effectFrameCount[EFFECT_EXPLOSION] = EXPLOSION_FRAMES;
+    for (int i = 0; i < EXPLOSION_FRAMES; ++i) {
+        effectFrames[EFFECT_EXPLOSION][i] = sf::Vector2f(i * EFFECT_FRAME_SIZE, 0);
+    }
+    effectTexelSize[EFFECT_EXPLOSION] = EFFECT_FRAME_SIZE;
+    effectDrawSize[EFFECT_EXPLOSION] = EFFECT_FRAME_SIZE;
+    effectLifetime[EFFECT_EXPLOSION] = 0.3f;
+    effectFades[EFFECT_EXPLOSION] = false;
+
+    effectFrameCount[EFFECT_DEATH] = DEATH_FRAMES;
+    for (int i = 0; i < DEATH_FRAMES; ++i) {
+        effectFrames[EFFECT_DEATH][i] = sf::Vector2f((i % DEATH_SHEET_COLUMNS) * EFFECT_FRAME_SIZE,
+                                                     DEATH_SHEET_Y + (i / DEATH_SHEET_COLUMNS) * EFFECT_FRAME_SIZE);
+    }
+    effectTexelSize[EFFECT_DEATH] = EFFECT_FRAME_SIZE;
+    effectDrawSize[EFFECT_DEATH] = EFFECT_FRAME_SIZE * 2;
+    effectLifetime[EFFECT_DEATH] = 1.2f;
+    effectFades[EFFECT_DEATH] = false;
+
+    // Debris shows a small patch from the middle of the brightest explosion frame
+    effectFrameCount[EFFECT_DEBRIS] = 1;
+    effectFrames[EFFECT_DEBRIS][0] = sf::Vector2f(EFFECT_FRAME_SIZE + 12, 12);
+    effectTexelSize[EFFECT_DEBRIS] = 8;
+    effectDrawSize[EFFECT_DEBRIS] = 6;
+    effectLifetime[EFFECT_DEBRIS] = 0.7f;
+    effectFades[EFFECT_DEBRIS] = true;
+    return true;
+}
+
+static void spawnParticle(int kind, float x, float y, float vx, float vy, float fall) {
+    if (particleCount == MAX_PARTICLES) return;
+    int i = particleCount++;
+    particleX[i] = x;
+    particleY[i] = y;
+    particleVX[i] = vx;
+    particleVY[i] = vy;
+    particleFall[i] = fall;
+    particleAge[i] = 0.0f;
+    particleLife[i] = effectLifetime[kind];
+    particleKind[i] = kind;
+}
+
+static void spawnDebris(float x, float y, int count, float speed) {
+    for (int i = 0; i < count; ++i) {
+        float angle = effectRandom() * 6.2831853f;
+        float burst = speed * (0.4f + 0.6f * effectRandom());
+        spawnParticle(EFFECT_DEBRIS, x, y, cos(angle) * burst, sin(angle) * burst - speed * 0.5f, DEBRIS_GRAVITY);
+    }
+}
+
+void spawnExplosion(float x, float y, int debrisCount) {
+    spawnParticle(EFFECT_EXPLOSION, x, y, 0.0f, 0.0f, 0.0f);
+    spawnDebris(x, y, debrisCount, 200.0f);
+}
+
+void spawnPlayerDeath(float x, float y) {
+    spawnParticle(EFFECT_DEATH, x, y, 0.0f, 0.0f, 0.0f);
+    spawnDebris(x, y, 48, 320.0f);
+}
+
+void updateEffects(float seconds) {
+    // Integrate everything in one pass the compiler can vectorize
+    for (int i = 0; i < particleCount; ++i) {
+        particleAge[i] += seconds;
+        particleVY[i] += particleFall[i] * seconds;
+        particleX[i] += particleVX[i] * seconds;
+        particleY[i] += particleVY[i] * seconds;
+    }
+
+    // Swap-remove finished particles so the live ones stay packed
+    int i = 0;
+    while (i < particleCount) {
+        if (particleAge[i] < particleLife[i]) {
+            ++i;
+            continue;
+        }
+        int last = --particleCount;
+        particleX[i] = particleX[last];
+        particleY[i] = particleY[last];
+        particleVX[i] = particleVX[last];
+        particleVY[i] = particleVY[last];
+        particleFall[i] = particleFall[last];
+        particleAge[i] = particleAge[last];
+        particleLife[i] = particleLife[last];
+        particleKind[i] = particleKind[last];
+    }
+}
+
+bool effectsActive() {
+    return particleCount > 0;
+}
+
+void drawEffects(sf::RenderTarget& target) {
+    if (particleCount == 0) return;
+
+    for (int i = 0; i < particleCount; ++i) {
+        int kind = particleKind[i];
+        float progress = particleAge[i] / particleLife[i];
+        int frame = static_cast<int>(progress * effectFrameCount[kind]);
+        if (frame >= effectFrameCount[kind]) frame = effectFrameCount[kind] - 1;
+
+        sf::Vector2f texel = effectFrames[kind][frame];
+        float texelSize = effectTexelSize[kind];
+        float half = effectDrawSize[kind] * 0.5f;
+        sf::Color color(255, 255, 255, effectFades[kind] ? static_cast<sf::Uint8>(255 * (1.0f - progress)) : 255);
+
+        sf::Vertex* quad = &particleVertices[i * 4];
+        quad[0] = sf::Vertex(sf::Vector2f(particleX[i] - half, particleY[i] - half), color, texel);
+        quad[1] = sf::Vertex(sf::Vector2f(particleX[i] + half, particleY[i] - half), color,
+                             sf::Vector2f(texel.x + texelSize, texel.y));
+        quad[2] = sf::Vertex(sf::Vector2f(particleX[i] + half, particleY[i] + half), color,
+                             sf::Vector2f(texel.x + texelSize, texel.y + texelSize));
+        quad[3] = sf::Vertex(sf::Vector2f(particleX[i] - half, particleY[i] + half), color,
+                             sf::Vector2f(texel.x, texel.y + texelSize));
+    }
+
+    target.draw(particleVertices, particleCount * 4, sf::Quads, sf::RenderStates(&effectAtlas));
+    addMetric(METRIC_DRAW_CALLS, 1);
+}
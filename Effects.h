@@ -0,0 +1,26 @@
+#ifndef EFFECTS_H
+#define EFFECTS_H
+
+#include <SFML/Graphics.hpp>
+
+// Visual effects for kills and deaths. Particles live in a fixed pool kept as
+// one array per field; finished ones are swap-removed, and the whole pool is
+// drawn as a single vertex batch from one atlas texture. Nothing here touches
+// the simulation or its random generator.
+
+const int MAX_PARTICLES = 4096; // Spawns beyond this are dropped
+
+const int EFFECT_EXPLOSION = 0; // explosion.png played in place
+const int EFFECT_DEATH = 1; // death.png played in place
+const int EFFECT_DEBRIS = 2; // Small fragment thrown outward that falls and fades
+const int NUM_EFFECTS = 3;
+
+bool loadEffects();
+// Positions are pixel centers
+void spawnExplosion(float x, float y, int debrisCount);
+void spawnPlayerDeath(float x, float y);
+void updateEffects(float seconds);
+bool effectsActive(); // Any particle still playing
+void drawEffects(sf::RenderTarget& target);
+
+#endif
@@ -0,0 +1,202 @@
+#include "Metrics.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+using namespace std;
+
+const int METRIC_COUNTER = 0;
+const int METRIC_GAUGE = 1;
+
+const char* METRIC_NAMES[NUM_METRICS] = {
+    "centipede_frames_total", "centipede_ticks_total", "centipede_games_total",
+    "centipede_collision_pairs_total", "centipede_draw_calls_total",
+    "centipede_high_score_writes_total", "centipede_telemetry_dropped_events_total",
+    "centipede_live_segments", "centipede_live_mushrooms", "centipede_groups",
+    "centipede_score", "centipede_captured_frames_total", "centipede_capture_dropped_frames_total",
+    "centipede_live_projectiles"
+};
+const char* METRIC_HELP[NUM_METRICS] = {
+    "Frames drawn", "Simulation ticks run", "Games finished",
+    "Collision pairs tested by simulation ticks", "Draw calls issued",
+    "Times the high score file was written", "Game events dropped because the telemetry ring was full",
+    "Centipede segments alive", "Mushrooms on the field", "Centipede groups",
+    "Score of the current game", "Frames handed to the capture encoder",
+    "Capture frames dropped because the encoder fell behind",
+    "Shots in flight"
+};
+const int METRIC_KINDS[NUM_METRICS] = {
+    METRIC_COUNTER, METRIC_COUNTER, METRIC_COUNTER, METRIC_COUNTER, METRIC_COUNTER,
+    METRIC_COUNTER, METRIC_COUNTER,
+    METRIC_GAUGE, METRIC_GAUGE, METRIC_GAUGE, METRIC_GAUGE,
+    METRIC_COUNTER, METRIC_COUNTER,
+    METRIC_GAUGE
+};
+
+const int MAX_BUCKETS = 12;
+const char* HISTOGRAM_NAMES[NUM_HISTOGRAMS] = {"centipede_frame_seconds", "centipede_tick_seconds"};
+const char* HISTOGRAM_HELP[NUM_HISTOGRAMS] = {"Time between frames", "Time to run one simulation tick"};
+// Upper bounds in nanoseconds, ascending; the +Inf bucket is implicit
+const int HISTOGRAM_BUCKET_COUNT[NUM_HISTOGRAMS] = {10, 9};
+const long long HISTOGRAM_BOUNDS[NUM_HISTOGRAMS][MAX_BUCKETS] = {
+    {1000000, 2000000, 4000000, 8333333, 16666667, 25000000, 33333333, 50000000, 100000000, 250000000},
+    {250, 500, 1000, 2500, 5000, 10000, 50000, 250000, 1000000}
+};
+
+atomic<long long> metricValues[NUM_METRICS];
+atomic<long long> histogramBuckets[NUM_HISTOGRAMS][MAX_BUCKETS + 1]; // Not cumulative; summed on export
+atomic<long long> histogramSum[NUM_HISTOGRAMS];
+
+thread metricsExporter;
+atomic<bool> metricsStopping(false);
+int metricsSocket = -1;
+string metricsFilePath;
+
+void addMetric(int metric, long long amount) {
+    metricValues[metric].fetch_add(amount, memory_order_relaxed);
+}
+
+void setMetric(int metric, long long value) {
+    metricValues[metric].store(value, memory_order_relaxed);
+}
+
+void observeHistogram(int histogram, long long nanos) {
+    int bucket = 0;
+    int bucketCount = HISTOGRAM_BUCKET_COUNT[histogram];
+    while (bucket < bucketCount && nanos > HISTOGRAM_BOUNDS[histogram][bucket]) {
+        ++bucket;
+    }
+    histogramBuckets[histogram][bucket].fetch_add(1, memory_order_relaxed);
+    histogramSum[histogram].fetch_add(nanos, memory_order_relaxed);
+}
+
+static string formatMetrics() {
+    string text;
+    char line[256];
+    for (int m = 0; m < NUM_METRICS; ++m) {
+        snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s %s\n%s %lld\n",
+                 METRIC_NAMES[m], METRIC_HELP[m], METRIC_NAMES[m],
+                 METRIC_KINDS[m] == METRIC_COUNTER ? "counter" : "gauge",
+                 METRIC_NAMES[m], metricValues[m].load(memory_order_relaxed));
+        text += line;
+    }
+    for (int h = 0; h < NUM_HISTOGRAMS; ++h) {
+        const char* name = HISTOGRAM_NAMES[h];
+        snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s histogram\n", name, HISTOGRAM_HELP[h], name);
+        text += line;
+        long long cumulative = 0;
+        for (int b = 0; b < HISTOGRAM_BUCKET_COUNT[h]; ++b) {
+            cumulative += histogramBuckets[h][b].load(memory_order_relaxed);
+            snprintf(line, sizeof(line), "%s_bucket{le=\"%g\"} %lld\n", name, HISTOGRAM_BOUNDS[h][b] / 1e9, cumulative);
+            text += line;
+        }
+        cumulative += histogramBuckets[h][HISTOGRAM_BUCKET_COUNT[h]].load(memory_order_relaxed);
+        snprintf(line, sizeof(line), "%s_bucket{le=\"+Inf\"} %lld\n%s_sum %g\n%s_count %lld\n",
+                 name, cumulative, name, histogramSum[h].load(memory_order_relaxed) / 1e9, name, cumulative);
+        text += line;
+    }
+    return text;
+}
+
+static void writeMetricsFile() {
+    // Write beside the target and rename so readers never see half a file
+    string temporary = metricsFilePath + ".tmp";
+    ofstream file(temporary);
+    if (!file.is_open()) return;
+    file << formatMetrics();
+    file.close();
+    rename(temporary.c_str(), metricsFilePath.c_str());
+}
+
+static void serveMetricsRequest(int client) {
+    // A client that connects and then stalls must not hold up the file writes
+    // or stopMetricsExport, so it gets a short wait for its request and for
+    // every send
+    const int CLIENT_TIMEOUT_MS = 200;
+    pollfd request = {client, POLLIN, 0};
+    if (poll(&request, 1, CLIENT_TIMEOUT_MS) <= 0) {
+        close(client);
+        return;
+    }
+    timeval sendTimeout = {0, CLIENT_TIMEOUT_MS * 1000};
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &sendTimeout, sizeof(sendTimeout));
+
+    // Whatever was asked for, the answer is the metrics page
+    char requestText[1024];
+    recv(client, requestText, sizeof(requestText), MSG_DONTWAIT);
+    string body = formatMetrics();
+    string response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                      to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t written = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (written <= 0) break;
+        sent += written;
+    }
+    close(client);
+}
+
+static void exporterLoop() {
+    const int POLL_MS = 200;
+    const int FILE_INTERVAL_MS = 1000;
+    chrono::steady_clock::time_point nextFileWrite = chrono::steady_clock::now();
+    while (!metricsStopping.load(memory_order_relaxed)) {
+        if (!metricsFilePath.empty() && chrono::steady_clock::now() >= nextFileWrite) {
+            writeMetricsFile();
+            nextFileWrite += chrono::milliseconds(FILE_INTERVAL_MS);
+        }
+        if (metricsSocket < 0) {
+            this_thread::sleep_for(chrono::milliseconds(POLL_MS));
+            continue;
+        }
+        pollfd listener = {metricsSocket, POLLIN, 0};
+        if (poll(&listener, 1, POLL_MS) > 0) {
+            int client = accept(metricsSocket, nullptr, nullptr);
+            if (client >= 0) serveMetricsRequest(client);
+        }
+    }
+    if (!metricsFilePath.empty()) writeMetricsFile();
+}
+
+bool startMetricsExport(int port, const char* filePath) {
+    if (port > 0) {
+        metricsSocket = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        setsockopt(metricsSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // Local scrapers only
+        if (metricsSocket < 0 || bind(metricsSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+            listen(metricsSocket, 8) < 0) {
+            std::cerr << "Failed to listen for metrics on 127.0.0.1:" << port << std::endl;
+            if (metricsSocket >= 0) close(metricsSocket);
+            metricsSocket = -1;
+            return false;
+        }
+    }
+    if (filePath) metricsFilePath = filePath;
+    metricsStopping.store(false);
+    metricsExporter = thread(exporterLoop);
+    return true;
+}
+
+void stopMetricsExport() {
+    if (!metricsExporter.joinable()) return;
+    metricsStopping.store(true);
+    metricsExporter.join();
+    if (metricsSocket >= 0) close(metricsSocket);
+    metricsSocket = -1;
+}
@@ -0,0 +1,39 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+// Runtime metrics. Every metric is a fixed slot updated with relaxed atomics,
+// cheap enough to leave on in the hot paths. A background thread serves them
+// in Prometheus text format on a localhost port, rewrites them to a file
+// every second, or both.
+
+// Counters and gauges
+const int METRIC_FRAMES = 0;
+const int METRIC_TICKS = 1;
+const int METRIC_GAMES = 2;
+const int METRIC_COLLISION_PAIRS = 3; // Collision pairs tested by real ticks, not lookahead
+const int METRIC_DRAW_CALLS = 4;
+const int METRIC_HIGH_SCORE_WRITES = 5;
+const int METRIC_TELEMETRY_DROPPED = 6;
+const int METRIC_LIVE_SEGMENTS = 7;
+const int METRIC_LIVE_MUSHROOMS = 8;
+const int METRIC_GROUPS = 9;
+const int METRIC_SCORE = 10;
+const int METRIC_CAPTURED_FRAMES = 11;
+const int METRIC_CAPTURE_DROPPED = 12; // Frames dropped because the encoder fell behind
+const int METRIC_LIVE_PROJECTILES = 13;
+const int NUM_METRICS = 14;
+
+// Histograms, observed in nanoseconds and exported in seconds
+const int HISTOGRAM_FRAME_TIME = 0;
+const int HISTOGRAM_TICK_TIME = 1;
+const int NUM_HISTOGRAMS = 2;
+
+void addMetric(int metric, long long amount);
+void setMetric(int metric, long long value);
+void observeHistogram(int histogram, long long nanos);
+
+// port 0 = no endpoint, filePath nullptr = no file
+bool startMetricsExport(int port, const char* filePath);
+void stopMetricsExport();
+
+#endif
@@ -0,0 +1,178 @@
+#include "MushroomField.h"
+#include <cstring>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+const char* FIELD_STRATEGY_NAMES[NUM_FIELD_STRATEGIES] = {"shuffle", "spaced", "rows"};
+
+// Scratch tables, one entry per tile, reused across calls. An entry only
+// counts if its stamp matches the current generation, so nothing is cleared
+// between fields.
+thread_local vector<int> shuffledTile;
+thread_local vector<unsigned int> shuffledStamp;
+thread_local vector<unsigned int> blockedStamp;
+thread_local unsigned int fieldGeneration = 0;
+
+static unsigned int randomBelow(unsigned int& random, unsigned int bound) {
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    return static_cast<unsigned int>((static_cast<uint64_t>(random) * bound) >> 32);
+}
+
+static void prepareScratch(int tileCount) {
+    if (static_cast<int>(shuffledTile.size()) < tileCount) {
+        shuffledTile.resize(tileCount);
+        shuffledStamp.resize(tileCount, 0);
+        blockedStamp.resize(tileCount, 0);
+    }
+    if (++fieldGeneration == 0) {
+        // Stamps wrapped around: start over with clean tables
+        fill(shuffledStamp.begin(), shuffledStamp.end(), 0);
+        fill(blockedStamp.begin(), blockedStamp.end(), 0);
+        fieldGeneration = 1;
+    }
+}
+
+// One Fisher-Yates shuffle over tiles base .. base + n - 1, drawn a step at
+// a time. Sparse draws keep the array virtual: an entry not yet written this
+// generation holds its own tile, so a few draws from a large field never
+// touch all n slots. Dense draws fill the array up front instead, which is
+// cheaper per step. Tables are read through plain pointers because every
+// access to a thread_local vector goes through a TLS lookup.
+struct TileShuffle {
+    int* tile;
+    unsigned int* stamp; // nullptr once the array is filled
+    unsigned int generation;
+    int base;
+    int n;
+};
+
+static TileShuffle startShuffle(int base, int n, int draws) {
+    TileShuffle shuffle = {shuffledTile.data(), shuffledStamp.data(), fieldGeneration, base, n};
+    if (draws * 4 >= n) {
+        for (int i = 0; i < n; ++i) {
+            shuffle.tile[base + i] = base + i;
+        }
+        shuffle.stamp = nullptr;
+    }
+    return shuffle;
+}
+
+static inline int shuffledAt(const TileShuffle& shuffle, int slot) {
+    if (!shuffle.stamp || shuffle.stamp[slot] == shuffle.generation) return shuffle.tile[slot];
+    return slot;
+}
+
+// Swaps a random not yet drawn tile into slot i and returns it
+static inline int drawTile(TileShuffle& shuffle, int i, unsigned int& random) {
+    int slot = shuffle.base + i;
+    int other = slot + static_cast<int>(randomBelow(random, shuffle.n - i));
+    int drawn = shuffledAt(shuffle, other);
+    shuffle.tile[other] = shuffledAt(shuffle, slot);
+    shuffle.tile[slot] = drawn;
+    if (shuffle.stamp) {
+        shuffle.stamp[other] = shuffle.generation;
+        shuffle.stamp[slot] = shuffle.generation;
+    }
+    return drawn;
+}
+
+static int generateShuffled(const FieldSpec& spec, int count, unsigned int& random, int tiles[]) {
+    TileShuffle shuffle = startShuffle(0, spec.columns * spec.rows, count);
+    for (int i = 0; i < count; ++i) {
+        tiles[i] = drawTile(shuffle, i, random);
+    }
+    return count;
+}
+
+static int generateSpaced(const FieldSpec& spec, int count, unsigned int& random, int tiles[]) {
+    // Dart throwing without repeats: tiles come in shuffled order, and each
+    // one placed blocks its neighbourhood so later candidates cost O(1)
+    int tileCount = spec.columns * spec.rows;
+    int reach = spec.spacing - 1;
+    int neighbourhood = (2 * reach + 1) * (2 * reach + 1);
+    // Each placement rules out up to a neighbourhood of tiles, so a dense request looks at most of them
+    TileShuffle shuffle = startShuffle(0, tileCount, count * neighbourhood);
+    unsigned int* blocked = blockedStamp.data();
+    unsigned int generation = fieldGeneration;
+    int placed = 0;
+    for (int i = 0; i < tileCount && placed < count; ++i) {
+        int tile = drawTile(shuffle, i, random);
+        if (blocked[tile] == generation) continue;
+        tiles[placed++] = tile;
+        
+        int row = tile / spec.columns, column = tile % spec.columns;
+        int top = row - reach < 0 ? 0 : row - reach;
+        int bottom = row + reach >= spec.rows ? spec.rows - 1 : row + reach;
+        int left = column - reach < 0 ? 0 : column - reach;
+        int right = column + reach >= spec.columns ? spec.columns - 1 : column + reach;
+        for (int y = top; y <= bottom; ++y) {
+            for (int x = left; x <= right; ++x) {
+                blocked[y * spec.columns + x] = generation;
+            }
+        }
+    }
+    return placed;
+}
+
+static int generateRowProfile(const FieldSpec& spec, int count, unsigned int& random, int tiles[]) {
+    // Row counts: the floor of each row's share first, then the remainder
+    // one at a time from a random row onward, skipping full rows
+    thread_local vector<int> rowCount;
+    rowCount.assign(spec.rows, 0);
+    int* rowCounts = rowCount.data();
+    float totalWeight = 0.0f;
+    for (int row = 0; row < spec.rows; ++row) {
+        totalWeight += spec.rowWeights ? spec.rowWeights[row] : static_cast<float>(spec.rows - row);
+    }
+    int assigned = 0;
+    for (int row = 0; row < spec.rows && totalWeight > 0.0f; ++row) {
+        float weight = spec.rowWeights ? spec.rowWeights[row] : static_cast<float>(spec.rows - row);
+        int share = static_cast<int>(count * weight / totalWeight);
+        rowCounts[row] = share > spec.columns ? spec.columns : share;
+        assigned += rowCounts[row];
+    }
+    int row = static_cast<int>(randomBelow(random, spec.rows));
+    while (assigned < count) {
+        if (rowCounts[row] < spec.columns) {
+            rowCounts[row]++;
+            assigned++;
+        }
+        row = row + 1 == spec.rows ? 0 : row + 1;
+    }
+    
+    int placed = 0;
+    for (row = 0; row < spec.rows; ++row) {
+        TileShuffle shuffle = startShuffle(row * spec.columns, spec.columns, rowCounts[row]);
+        for (int i = 0; i < rowCounts[row]; ++i) {
+            tiles[placed++] = drawTile(shuffle, i, random);
+        }
+    }
+    return placed;
+}
+
+int generateMushroomField(const FieldSpec& spec, unsigned int& random, int tiles[]) {
+    int tileCount = spec.columns * spec.rows;
+    int count = spec.count < tileCount ? spec.count : tileCount;
+    if (count <= 0) return 0;
+    prepareScratch(tileCount);
+    
+    switch (spec.strategy) {
+        case FIELD_SPACED:
+            return generateSpaced(spec, count, random, tiles);
+        case FIELD_ROW_PROFILE:
+            return generateRowProfile(spec, count, random, tiles);
+        default:
+            return generateShuffled(spec, count, random, tiles);
+    }
+}
+
+int fieldStrategyFromName(const char* name) {
+    for (int i = 0; i < NUM_FIELD_STRATEGIES; ++i) {
+        if (strcmp(name, FIELD_STRATEGY_NAMES[i]) == 0) return i;
+    }
+    return -1;
+}
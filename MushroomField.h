@@ -0,0 +1,30 @@
+#ifndef MUSHROOM_FIELD_H
+#define MUSHROOM_FIELD_H
+
+// Mushroom field generation. A field is laid out on a columns x rows tile
+// grid and written out as tile indices (row * columns + column), each tile
+// used at most once. Every strategy takes time proportional to the mushrooms
+// placed (FIELD_SPACED: to the tiles it has to look at), draws only from the
+// xorshift state it is handed, so a wave can be generated ahead of time from
+// its own seed, and allocates nothing once its scratch tables have grown to
+// the largest field seen on the thread.
+
+const int FIELD_SHUFFLE = 0; // Uniform: partial Fisher-Yates over the free tiles
+const int FIELD_SPACED = 1; // Blue noise: no two mushrooms closer than spacing tiles
+const int FIELD_ROW_PROFILE = 2; // Row counts follow rowWeights, tiles shuffled within each row
+const int NUM_FIELD_STRATEGIES = 3;
+
+struct FieldSpec {
+    int strategy;
+    int columns;
+    int rows;
+    int count; // Mushrooms wanted; FIELD_SPACED places fewer if they do not fit
+    int spacing; // FIELD_SPACED: minimum distance in tiles, counting diagonals as 1
+    const float* rowWeights; // FIELD_ROW_PROFILE: one per row, nullptr thins out toward the bottom
+};
+
+// Returns the number of tiles written
+int generateMushroomField(const FieldSpec& spec, unsigned int& random, int tiles[]);
+int fieldStrategyFromName(const char* name); // -1 if unknown
+
+#endif
@@ -0,0 +1,621 @@
+#include "Netplay.h"
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <climits>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <vector>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+const unsigned int NET_MAGIC = 0x50544e43u; // "CNTP"
+const int NET_HISTORY = 32; // Ticks of snapshots, outcomes and hashes kept, a power of two
+const int NET_INPUT_HISTORY = 64; // Ticks of inputs kept, a power of two
+const int MAX_PACKET_INPUTS = 32;
+static_assert(NET_HISTORY > NET_MAX_ROLLBACK_TICKS + 1, "rollback reaches past the snapshots");
+static_assert(NET_INPUT_HISTORY >= MAX_PACKET_INPUTS, "resent inputs must still be kept");
+
+// Packet, little-endian: magic, seed, first tick, input count, ack tick,
+// hash tick, hash, then one input mask byte per tick from the first
+const int PACKET_HEADER_BYTES = 25;
+const int MAX_PACKET_BYTES = PACKET_HEADER_BYTES + MAX_PACKET_INPUTS;
+
+const int DELAY_QUEUE_PACKETS = 256; // Packets held back to fake latency
+const int LINGER_MILLIS = 1000;
+const int LOOPBACK_CONNECT_SECONDS = 5;
+
+struct DelayedPacket {
+    chrono::steady_clock::time_point due;
+    int length;
+    unsigned char bytes[MAX_PACKET_BYTES];
+};
+
+struct TickEvents {
+    int count;
+    GameEvent events[NET_TICK_EVENTS];
+};
+
+struct NetSession {
+    int socket;
+    bool host;
+    bool peerKnown;
+    sockaddr_in peer;
+    bool started;
+    unsigned int seed;
+
+    int currentTick; // Next tick to simulate
+    int remoteConfirmed; // Last tick the remote input is known for
+    int remoteAck; // Last tick the remote peer has our input for
+    int rollbackFrom; // Earliest tick simulated with a wrong prediction, INT_MAX if none
+    int checkedTick; // Next confirmed tick to check for the end of the game
+    int result; // TICK_RUNNING until a game-ending tick is confirmed
+    int endTick;
+    int remoteHashTick;
+    unsigned int remoteHash;
+
+    unsigned char localInputs[NET_INPUT_HISTORY];
+    unsigned char remoteInputs[NET_INPUT_HISTORY];
+    unsigned char usedRemote[NET_HISTORY]; // Remote input each tick was last simulated with
+    int outcomes[NET_HISTORY];
+    unsigned int hashes[NET_HISTORY]; // World hash after each tick
+    WorldState snapshots[NET_HISTORY]; // World before each tick
+    TickEvents events[NET_HISTORY]; // Events of each tick, passed on once it is confirmed
+
+    int latencyMillis;
+    int lossPercent;
+    unsigned int lossRandom;
+    DelayedPacket delayed[DELAY_QUEUE_PACKETS];
+    int delayedHead;
+    int delayedCount;
+
+    NetStats stats;
+};
+
+static void put32(unsigned char* bytes, unsigned int value) {
+    for (int i = 0; i < 4; ++i) bytes[i] = static_cast<unsigned char>(value >> (8 * i));
+}
+
+static unsigned int get32(const unsigned char* bytes) {
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<unsigned int>(bytes[3]) << 24);
+}
+
+static unsigned char packInput(const bool input[]) {
+    unsigned char mask = 0;
+    for (int i = 0; i < NUM_INPUTS; ++i) {
+        if (input[i]) mask |= 1 << i;
+    }
+    return mask;
+}
+
+static void unpackInput(unsigned char mask, bool input[]) {
+    for (int i = 0; i < NUM_INPUTS; ++i) {
+        input[i] = (mask >> i) & 1;
+    }
+}
+
+static int confirmedTick(const NetSession* session) {
+    return min(session->remoteConfirmed, session->currentTick - 1);
+}
+
+// Where simulateTick collects the events of the tick it runs
+thread_local TickEvents* collectingEvents = nullptr;
+thread_local long long* droppedEventCount = nullptr;
+
+static void collectEvent(const GameEvent& event) {
+    if (collectingEvents->count == NET_TICK_EVENTS) {
+        (*droppedEventCount)++;
+        return;
+    }
+    collectingEvents->events[collectingEvents->count++] = event;
+}
+
+static NetSession* openNetSession(int port) {
+    int handle = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (handle == -1) {
+        cerr << "Failed to create a UDP socket" << endl;
+        return nullptr;
+    }
+    sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(static_cast<unsigned short>(port));
+    if (bind(handle, reinterpret_cast<sockaddr*>(&local), sizeof(local)) == -1 ||
+        fcntl(handle, F_SETFL, fcntl(handle, F_GETFL) | O_NONBLOCK) == -1) {
+        cerr << "Failed to bind UDP port " << port << endl;
+        close(handle);
+        return nullptr;
+    }
+
+    NetSession* session = new NetSession();
+    session->socket = handle;
+    session->peerKnown = false;
+    session->started = false;
+    session->seed = 0;
+    session->latencyMillis = 0;
+    session->lossPercent = 0;
+    session->lossRandom = 2463534242u;
+    session->delayedHead = 0;
+    session->delayedCount = 0;
+    memset(&session->stats, 0, sizeof(session->stats));
+    session->stats.confirmedTick = -1;
+    return session;
+}
+
+NetSession* hostNetSession(int port, unsigned int seed) {
+    NetSession* session = openNetSession(port);
+    if (!session) return nullptr;
+    session->host = true;
+    session->seed = seed ? seed : 1; // Zero marks a guest that has not started
+    return session;
+}
+
+NetSession* joinNetSession(const char* address) {
+    string text = address;
+    size_t colon = text.rfind(':');
+    if (colon == string::npos) {
+        cerr << "Peer address must look like host:port, got " << address << endl;
+        return nullptr;
+    }
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(text.substr(0, colon).c_str(), text.substr(colon + 1).c_str(), &hints, &found) != 0 || !found) {
+        cerr << "Failed to resolve " << address << endl;
+        return nullptr;
+    }
+    NetSession* session = openNetSession(0);
+    if (session) {
+        session->host = false;
+        memcpy(&session->peer, found->ai_addr, sizeof(session->peer));
+        session->peerKnown = true;
+    }
+    freeaddrinfo(found);
+    return session;
+}
+
+void setNetConditions(NetSession* session, int latencyMillis, int lossPercent) {
+    session->latencyMillis = max(0, latencyMillis);
+    session->lossPercent = min(max(0, lossPercent), 100);
+}
+
+int netSessionPort(NetSession* session) {
+    sockaddr_in local;
+    socklen_t length = sizeof(local);
+    if (getsockname(session->socket, reinterpret_cast<sockaddr*>(&local), &length) == -1) return 0;
+    return ntohs(local.sin_port);
+}
+
+NetStats netStats(NetSession* session) {
+    NetStats stats = session->stats;
+    stats.confirmedTick = session->started ? confirmedTick(session) : -1;
+    return stats;
+}
+
+static void startGame(NetSession* session) {
+    randomState = session->seed;
+    coopGame = true;
+    initializeGame();
+    session->started = true;
+    session->currentTick = 0;
+    session->remoteConfirmed = -1;
+    session->remoteAck = -1;
+    session->rollbackFrom = INT_MAX;
+    session->checkedTick = 0;
+    session->result = TICK_RUNNING;
+    session->endTick = -1;
+    session->remoteHashTick = -1;
+    session->remoteHash = 0;
+}
+
+static void flushDelayedPackets(NetSession* session) {
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    while (session->delayedCount > 0 && session->delayed[session->delayedHead].due <= now) {
+        const DelayedPacket& packet = session->delayed[session->delayedHead];
+        sendto(session->socket, packet.bytes, packet.length, 0,
+               reinterpret_cast<const sockaddr*>(&session->peer), sizeof(session->peer));
+        session->delayedHead = (session->delayedHead + 1) % DELAY_QUEUE_PACKETS;
+        session->delayedCount--;
+    }
+}
+
+static void sendPacket(NetSession* session, const unsigned char* bytes, int length) {
+    session->stats.packetsSent++;
+    if (session->lossPercent > 0) {
+        session->lossRandom ^= session->lossRandom << 13;
+        session->lossRandom ^= session->lossRandom >> 17;
+        session->lossRandom ^= session->lossRandom << 5;
+        if (static_cast<int>(session->lossRandom % 100) < session->lossPercent) return;
+    }
+    if (session->latencyMillis == 0) {
+        sendto(session->socket, bytes, length, 0,
+               reinterpret_cast<const sockaddr*>(&session->peer), sizeof(session->peer));
+        return;
+    }
+    if (session->delayedCount == DELAY_QUEUE_PACKETS) return; // Counts as lost
+    DelayedPacket& packet = session->delayed[(session->delayedHead + session->delayedCount) % DELAY_QUEUE_PACKETS];
+    packet.due = chrono::steady_clock::now() + chrono::milliseconds(session->latencyMillis);
+    packet.length = length;
+    memcpy(packet.bytes, bytes, length);
+    session->delayedCount++;
+}
+
+static void sendInputs(NetSession* session) {
+    if (!session->peerKnown) return;
+    unsigned char bytes[MAX_PACKET_BYTES];
+    int first = 0, count = 0, hashTick = -1;
+    if (session->started) {
+        // Everything the peer has not acknowledged, up to what it can still need
+        first = max(session->remoteAck + 1, session->currentTick - MAX_PACKET_INPUTS);
+        count = max(0, session->currentTick - first);
+        hashTick = confirmedTick(session);
+    }
+    put32(bytes, NET_MAGIC);
+    put32(bytes + 4, session->started || session->host ? session->seed : 0);
+    put32(bytes + 8, static_cast<unsigned int>(first));
+    bytes[12] = static_cast<unsigned char>(count);
+    put32(bytes + 13, static_cast<unsigned int>(session->started ? session->remoteConfirmed : -1));
+    put32(bytes + 17, static_cast<unsigned int>(hashTick));
+    put32(bytes + 21, hashTick >= 0 ? session->hashes[hashTick & (NET_HISTORY - 1)] : 0);
+    for (int k = 0; k < count; ++k) {
+        bytes[PACKET_HEADER_BYTES + k] = session->localInputs[(first + k) & (NET_INPUT_HISTORY - 1)];
+    }
+    sendPacket(session, bytes, PACKET_HEADER_BYTES + count);
+}
+
+static void receivePackets(NetSession* session) {
+    unsigned char bytes[MAX_PACKET_BYTES + 1];
+    sockaddr_in from;
+    socklen_t fromLength = sizeof(from);
+    ssize_t length;
+    while ((length = recvfrom(session->socket, bytes, sizeof(bytes), 0,
+                              reinterpret_cast<sockaddr*>(&from), &fromLength)) > 0) {
+        fromLength = sizeof(from);
+        if (length < PACKET_HEADER_BYTES || get32(bytes) != NET_MAGIC ||
+            length != PACKET_HEADER_BYTES + bytes[12]) continue;
+        if (!session->peerKnown) {
+            session->peer = from; // The host plays whoever calls first
+            session->peerKnown = true;
+        } else if (from.sin_addr.s_addr != session->peer.sin_addr.s_addr || from.sin_port != session->peer.sin_port) {
+            continue;
+        }
+        session->stats.packetsReceived++;
+
+        unsigned int seed = get32(bytes + 4);
+        if (!session->started) {
+            if (!session->host) {
+                if (seed == 0) continue;
+                session->seed = seed;
+            }
+            startGame(session);
+        } else if (seed != 0 && seed != session->seed) {
+            continue;
+        }
+
+        int first = static_cast<int>(get32(bytes + 8));
+        int count = bytes[12];
+        session->remoteAck = max(session->remoteAck, static_cast<int>(get32(bytes + 13)));
+        int hashTick = static_cast<int>(get32(bytes + 17));
+        if (hashTick > session->remoteHashTick) {
+            session->remoteHashTick = hashTick;
+            session->remoteHash = get32(bytes + 21);
+        }
+
+        // Inputs arrive in order; repeats of known ticks are skipped
+        for (int k = 0; k < count; ++k) {
+            int tick = first + k;
+            if (tick != session->remoteConfirmed + 1) continue;
+            unsigned char mask = bytes[PACKET_HEADER_BYTES + k];
+            session->remoteInputs[tick & (NET_INPUT_HISTORY - 1)] = mask;
+            session->remoteConfirmed = tick;
+            if (tick < session->currentTick && session->usedRemote[tick & (NET_HISTORY - 1)] != mask) {
+                session->rollbackFrom = min(session->rollbackFrom, tick);
+            }
+        }
+    }
+}
+
+static void simulateTick(NetSession* session, int tick) {
+    int slot = tick & (NET_HISTORY - 1);
+    saveWorldState(session->snapshots[slot]);
+
+    // The remote player is predicted to hold its last known input
+    int known = min(tick, session->remoteConfirmed);
+    unsigned char remote = known >= 0 ? session->remoteInputs[known & (NET_INPUT_HISTORY - 1)] : 0;
+    session->usedRemote[slot] = remote;
+
+    bool local[NUM_INPUTS], other[NUM_INPUTS];
+    unpackInput(session->localInputs[tick & (NET_INPUT_HISTORY - 1)], local);
+    unpackInput(remote, other);
+    GameEventSink sink = gameEventSink;
+    gameEventSink = collectEvent;
+    collectingEvents = &session->events[slot];
+    collectingEvents->count = 0;
+    droppedEventCount = &session->stats.droppedEvents;
+    session->outcomes[slot] = session->host ? updateGame(local, other) : updateGame(other, local);
+    gameEventSink = sink;
+    session->hashes[slot] = worldHashTotal();
+}
+
+static void rollBack(NetSession* session) {
+    if (session->rollbackFrom >= session->currentTick) {
+        session->rollbackFrom = INT_MAX;
+        return;
+    }
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    loadWorldState(session->snapshots[session->rollbackFrom & (NET_HISTORY - 1)]);
+    for (int tick = session->rollbackFrom; tick < session->currentTick; ++tick) {
+        simulateTick(session, tick); // Replaces the events the misprediction held
+    }
+
+    long long nanos = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    session->stats.rollbacks++;
+    session->stats.deepestRollback = max(session->stats.deepestRollback, session->currentTick - session->rollbackFrom);
+    session->stats.slowestRollbackNanos = max(session->stats.slowestRollbackNanos, nanos);
+    session->rollbackFrom = INT_MAX;
+}
+
+static void checkConfirmedTicks(NetSession* session) {
+    int confirmed = confirmedTick(session);
+    int hashTick = session->remoteHashTick;
+    if (!session->stats.desynced && hashTick >= 0 && hashTick <= confirmed &&
+        hashTick > session->currentTick - NET_HISTORY &&
+        session->hashes[hashTick & (NET_HISTORY - 1)] != session->remoteHash) {
+        session->stats.desynced = true;
+        cerr << "Co-op desync at tick " << hashTick << endl;
+    }
+
+    while (session->result == TICK_RUNNING && session->checkedTick <= confirmed) {
+        int slot = session->checkedTick & (NET_HISTORY - 1);
+        if (gameEventSink) {
+            for (int e = 0; e < session->events[slot].count; ++e) {
+                gameEventSink(session->events[slot].events[e]);
+            }
+        }
+        int outcome = session->outcomes[slot];
+        if (outcome != TICK_RUNNING) {
+            // Both peers stop on the world right after the ending tick
+            session->result = outcome;
+            session->endTick = session->checkedTick;
+            if (session->endTick + 1 < session->currentTick) {
+                loadWorldState(session->snapshots[(session->endTick + 1) & (NET_HISTORY - 1)]);
+            }
+        }
+        session->checkedTick++;
+    }
+}
+
+bool pollNetSession(NetSession* session) {
+    receivePackets(session);
+    if (session->started && session->result == TICK_RUNNING) {
+        rollBack(session);
+        checkConfirmedTicks(session);
+    }
+    flushDelayedPackets(session);
+    sendInputs(session);
+    return session->started;
+}
+
+int netplayTick(NetSession* session, const bool localInput[]) {
+    if (!pollNetSession(session)) return NET_STALLED;
+    if (session->result != TICK_RUNNING) return session->result;
+    if (session->currentTick - session->remoteConfirmed > NET_MAX_ROLLBACK_TICKS) {
+        session->stats.stalls++;
+        return NET_STALLED;
+    }
+
+    session->localInputs[session->currentTick & (NET_INPUT_HISTORY - 1)] = packInput(localInput);
+    simulateTick(session, session->currentTick);
+    session->currentTick++;
+    session->stats.ticks++;
+    checkConfirmedTicks(session);
+    sendInputs(session);
+    return session->result;
+}
+
+void closeNetSession(NetSession* session) {
+    // Stay long enough for the peer to get the inputs it still needs
+    if (session->started) {
+        int lastNeeded = session->result != TICK_RUNNING ? session->endTick : session->currentTick - 1;
+        chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::milliseconds(LINGER_MILLIS);
+        while (session->remoteAck < lastNeeded && chrono::steady_clock::now() < deadline) {
+            pollNetSession(session);
+            this_thread::sleep_for(chrono::milliseconds(5));
+        }
+    }
+    close(session->socket);
+    coopGame = false;
+    delete session;
+}
+
+struct LoopbackPeer {
+    NetSession* session;
+    long long ticks;
+    unsigned int inputRandom;
+    bool connected;
+    int result;
+    vector<unsigned char> inputs; // Mask played on each tick
+    vector<GameEvent> events; // As passed on by the session
+};
+
+thread_local vector<GameEvent>* loopbackEvents = nullptr;
+
+static void recordLoopbackEvent(const GameEvent& event) {
+    loopbackEvents->push_back(event);
+}
+
+static void runLoopbackPeer(LoopbackPeer* peer, atomic<int>* finishedPeers) {
+    const chrono::microseconds TICK_TIME(1000000 / TICKS_PER_SECOND);
+    NetSession* session = peer->session;
+    loopbackEvents = &peer->events;
+    gameEventSink = recordLoopbackEvent;
+    chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::seconds(LOOPBACK_CONNECT_SECONDS);
+    while (!(peer->connected = pollNetSession(session)) && chrono::steady_clock::now() < deadline) {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    // Random inputs held for a random number of ticks, so predictions miss
+    bool input[NUM_INPUTS];
+    unsigned char mask = 0;
+    int hold = 0;
+    peer->result = TICK_RUNNING;
+    chrono::steady_clock::time_point nextTick = chrono::steady_clock::now();
+    while (peer->connected && session->stats.ticks < peer->ticks && peer->result == TICK_RUNNING) {
+        if (--hold <= 0) {
+            peer->inputRandom ^= peer->inputRandom << 13;
+            peer->inputRandom ^= peer->inputRandom >> 17;
+            peer->inputRandom ^= peer->inputRandom << 5;
+            mask = peer->inputRandom & ((1 << NUM_INPUTS) - 1);
+            hold = 1 + (peer->inputRandom >> 8) % 30;
+        }
+        unpackInput(mask, input);
+        int tick = session->currentTick;
+        int outcome = netplayTick(session, input);
+        if (outcome != NET_STALLED) peer->result = outcome;
+        if (session->currentTick > tick) peer->inputs[tick] = mask;
+        nextTick += TICK_TIME;
+        this_thread::sleep_until(nextTick);
+    }
+
+    // Keep the other peer supplied until it is done as well
+    finishedPeers->fetch_add(1);
+    deadline = chrono::steady_clock::now() + chrono::seconds(LOOPBACK_CONNECT_SECONDS);
+    while (finishedPeers->load() < 2 && chrono::steady_clock::now() < deadline) {
+        pollNetSession(session);
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    for (int i = 0; i < 50; ++i) { // Settle the last acknowledgements and rollbacks
+        pollNetSession(session);
+        this_thread::sleep_for(chrono::milliseconds(2 + session->latencyMillis / 25));
+    }
+    gameEventSink = nullptr;
+}
+
+// Plays the inputs both peers recorded on this thread, without the network
+static void playLoopbackOffline(const LoopbackPeer& hostPeer, const LoopbackPeer& guestPeer,
+                                unsigned int seed, int ticks, vector<GameEvent>& events) {
+    loopbackEvents = &events;
+    gameEventSink = recordLoopbackEvent;
+    randomState = seed;
+    coopGame = true;
+    initializeGame();
+    bool hostInput[NUM_INPUTS], guestInput[NUM_INPUTS];
+    for (int tick = 0; tick < ticks; ++tick) {
+        unpackInput(hostPeer.inputs[tick], hostInput);
+        unpackInput(guestPeer.inputs[tick], guestInput);
+        if (updateGame(hostInput, guestInput) != TICK_RUNNING) break;
+    }
+    gameEventSink = nullptr;
+    coopGame = false;
+}
+
+// A peer passes on the events of every tick it has confirmed, which must be
+// the offline run's events up to that tick
+static bool eventsMatch(const char* name, const NetSession* session, const vector<GameEvent>& events,
+                        const vector<GameEvent>& offline) {
+    size_t expected = 0;
+    while (expected < offline.size() && offline[expected].tick <= static_cast<unsigned int>(session->checkedTick)) {
+        ++expected;
+    }
+    size_t same = 0;
+    while (same < events.size() && same < expected && events[same].tick == offline[same].tick &&
+           events[same].type == offline[same].type && events[same].a == offline[same].a &&
+           events[same].b == offline[same].b && events[same].c == offline[same].c) {
+        ++same;
+    }
+    if (same == expected && events.size() == expected) {
+        cout << name << ": " << expected << " events match the offline run" << endl;
+        return true;
+    }
+    cout << name << ": event " << same << " differs from the offline run (" << events.size()
+         << " events passed on, " << expected << " expected)" << endl;
+    return false;
+}
+
+static void reportLoopbackPeer(const char* name, NetSession* session) {
+    NetStats stats = netStats(session);
+    cout << name << ": " << stats.ticks << " ticks, " << stats.rollbacks << " rollbacks (deepest "
+         << stats.deepestRollback << " ticks, slowest " << stats.slowestRollbackNanos / 1000 << " us), "
+         << stats.stalls << " stalls, " << stats.packetsSent << " packets sent, "
+         << stats.packetsReceived << " received" << endl;
+}
+
+bool runNetplayLoopbackTest(long long ticks, unsigned int seed, int latencyMillis, int lossPercent) {
+    NetSession* host = hostNetSession(0, seed);
+    if (!host) return false;
+    string address = "127.0.0.1:" + to_string(netSessionPort(host));
+    NetSession* guest = joinNetSession(address.c_str());
+    if (!guest) {
+        closeNetSession(host);
+        return false;
+    }
+    setNetConditions(host, latencyMillis, lossPercent);
+    setNetConditions(guest, latencyMillis, lossPercent);
+
+    // Each peer thread owns its own world
+    atomic<int> finishedPeers(0);
+    LoopbackPeer hostPeer = {host, ticks, seed ^ 0x9e3779b9u, false, TICK_RUNNING, {}, {}};
+    LoopbackPeer guestPeer = {guest, ticks, seed ^ 0x85ebca6bu, false, TICK_RUNNING, {}, {}};
+    hostPeer.inputs.resize(ticks);
+    guestPeer.inputs.resize(ticks);
+    if (hostPeer.inputRandom == 0) hostPeer.inputRandom = 1;
+    if (guestPeer.inputRandom == 0) guestPeer.inputRandom = 1;
+    thread hostThread(runLoopbackPeer, &hostPeer, &finishedPeers);
+    thread guestThread(runLoopbackPeer, &guestPeer, &finishedPeers);
+    hostThread.join();
+    guestThread.join();
+
+    cout << "loopback co-op, " << latencyMillis << " ms latency, " << lossPercent << "% loss each way" << endl;
+    reportLoopbackPeer("host", host);
+    reportLoopbackPeer("guest", guest);
+
+    bool agree = hostPeer.connected && guestPeer.connected && !host->stats.desynced && !guest->stats.desynced;
+    if (!hostPeer.connected || !guestPeer.connected) {
+        cout << "peers never connected" << endl;
+    } else if (hostPeer.result != guestPeer.result || host->endTick != guest->endTick) {
+        cout << "peers disagree on how the game ended" << endl;
+        agree = false;
+    } else {
+        int tick = min(confirmedTick(host), confirmedTick(guest));
+        bool comparable = tick >= 0 && tick > host->currentTick - NET_HISTORY && tick > guest->currentTick - NET_HISTORY;
+        unsigned int hostHash = host->hashes[tick & (NET_HISTORY - 1)];
+        if (!comparable || hostHash != guest->hashes[tick & (NET_HISTORY - 1)]) {
+            cout << "worlds differ at tick " << tick << endl;
+            agree = false;
+        } else {
+            cout << "worlds agree at tick " << tick << " (hash " << hex << hostHash << dec << ")";
+            if (hostPeer.result != TICK_RUNNING) {
+                cout << ", game " << (hostPeer.result == TICK_PLAYER_WON ? "won" : "lost") << " at tick " << host->endTick;
+            }
+            cout << endl;
+        }
+    }
+
+    if (agree) {
+        if (host->stats.rollbacks + guest->stats.rollbacks == 0) {
+            cout << "no prediction missed, so nothing was rolled back" << endl;
+            agree = false;
+        }
+        vector<GameEvent> offline;
+        playLoopbackOffline(hostPeer, guestPeer, host->seed, max(host->checkedTick, guest->checkedTick), offline);
+        bool hostMatches = eventsMatch("host", host, hostPeer.events, offline);
+        bool guestMatches = eventsMatch("guest", guest, guestPeer.events, offline);
+        agree = agree && hostMatches && guestMatches;
+    }
+    close(host->socket);
+    close(guest->socket);
+    delete host;
+    delete guest;
+    return agree;
+}
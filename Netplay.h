@@ -0,0 +1,67 @@
+#ifndef NETPLAY_H
+#define NETPLAY_H
+
+#include "Simulation.h"
+
+// Two-player co-op over UDP with rollback. Both peers run the whole game on
+// the calling thread's world and exchange nothing but input masks. The host
+// plays player one and picks the seed; the guest plays the partner.
+//
+// Every tick is simulated at once with the local input and a prediction of
+// the remote one (its last known input). The world is snapshotted before
+// every tick; when a remote input turns out to differ from the prediction,
+// the world rolls back to that tick's snapshot and the ticks since are
+// simulated again. A peer more than NET_MAX_ROLLBACK_TICKS ahead of the
+// remote input it has waits instead. Packets repeat every input the other
+// peer has not acknowledged, so a lost packet costs nothing but latency, and
+// carry a world hash of a confirmed tick so that desyncs are caught.
+//
+// Game events are held back until their tick is confirmed: each tick's events
+// are kept with its snapshot, replaced when a rollback simulates it again, and
+// passed to the thread's gameEventSink once both inputs for it are known. The
+// sink sees what really happened, a little later, and never a misprediction.
+
+const int NET_MAX_ROLLBACK_TICKS = 12;
+const int NET_STALLED = -1; // netplayTick result: waiting for the remote peer, nothing simulated
+const int NET_TICK_EVENTS = 128; // Events held per unconfirmed tick
+
+struct NetSession;
+
+NetSession* hostNetSession(int port, unsigned int seed); // port 0 picks a free one
+NetSession* joinNetSession(const char* address); // "host:port"
+void closeNetSession(NetSession* session); // Gives the peer up to a second to get the last inputs
+// Artificial conditions on everything this peer sends, for testing
+void setNetConditions(NetSession* session, int latencyMillis, int lossPercent);
+int netSessionPort(NetSession* session);
+
+// Exchanges packets. Once both peers have heard from each other this sets up
+// a co-op game on the calling thread and returns true.
+bool pollNetSession(NetSession* session);
+// Runs one tick with the local input. Returns TICK_RUNNING while the game is
+// on, NET_STALLED when it has to wait for the remote peer, and the outcome
+// once a game-ending tick has been confirmed by both inputs.
+int netplayTick(NetSession* session, const bool localInput[]);
+
+struct NetStats {
+    long long ticks; // Simulated for the first time
+    long long rollbacks;
+    int deepestRollback; // Ticks simulated again
+    long long slowestRollbackNanos;
+    long long stalls;
+    long long packetsSent;
+    long long packetsReceived;
+    int confirmedTick; // Last tick both inputs are known for, -1 before the first
+    long long droppedEvents; // Past NET_TICK_EVENTS in one tick
+    bool desynced;
+};
+NetStats netStats(NetSession* session);
+
+// Plays two peers against each other over loopback on two threads for a
+// number of ticks, with random inputs and the given conditions, and reports
+// rollbacks, stalls and whether both worlds agree. The inputs both peers
+// played are then run again without the network, and each peer's event
+// stream must match that run's. Returns true if everything agrees and at
+// least one prediction missed, so rollbacks were really tested.
+bool runNetplayLoopbackTest(long long ticks, unsigned int seed, int latencyMillis, int lossPercent);
+
+#endif
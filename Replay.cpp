@@ -0,0 +1,160 @@
+#include "Replay.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+#include <cstdlib>
+
+using namespace std;
+
+const char* REPLAY_MAGIC = "CENTIPEDE-REPLAY";
+const int REPLAY_VERSION = 2; // 2 added the mushroom field strategy
+
+const char* HASH_FIELD_NAMES[NUM_HASH_FIELDS] = {
+    "player", "projectiles", "centipede", "groups", "mushrooms", "score", "timers"
+};
+
+ofstream recordFile;
+
+bool startRecording(const char* path) {
+    recordFile.open(path);
+    if (!recordFile.is_open()) {
+        cerr << "Failed to open replay file " << path << endl;
+        return false;
+    }
+    recordFile << REPLAY_MAGIC << " " << REPLAY_VERSION << "\n";
+    recordFile << "seed " << randomState << "\n";
+    recordFile << "field " << mushroomFieldStrategy << "\n";
+    return true;
+}
+
+void recordReset() {
+    if (recordFile.is_open()) {
+        recordFile << "r\n";
+    }
+}
+
+void recordTick(const bool input[]) {
+    if (!recordFile.is_open()) return;
+
+    int mask = 0;
+    for (int i = 0; i < NUM_INPUTS; ++i) {
+        if (input[i]) mask |= 1 << i;
+    }
+    recordFile << mask << hex;
+    for (int f = 0; f < NUM_HASH_FIELDS; ++f) {
+        recordFile << " " << worldHash[f];
+    }
+    recordFile << dec << "\n";
+}
+
+void stopRecording() {
+    if (recordFile.is_open()) {
+        recordFile.close();
+    }
+}
+
+bool isRecording() {
+    return recordFile.is_open();
+}
+
+static bool verifyReplay(const string& path) {
+    ifstream file(path);
+    string magic, key;
+    int version = 0;
+    string fieldKey;
+    unsigned int seed = 0;
+    int field = 0;
+    if (!(file >> magic >> version >> key >> seed >> fieldKey >> field) || magic != REPLAY_MAGIC ||
+        version != REPLAY_VERSION || key != "seed" || fieldKey != "field") {
+        cout << path << ": not a version " << REPLAY_VERSION << " replay" << endl;
+        return false;
+    }
+    if (field < 0 || field >= NUM_FIELD_STRATEGIES) {
+        cout << path << ": unknown field strategy " << field << endl;
+        return false;
+    }
+    randomState = seed;
+    mushroomFieldStrategy = field;
+
+    bool input[NUM_INPUTS];
+    unsigned int expected[NUM_HASH_FIELDS];
+    long long tick = 0;
+    int games = 0;
+    string token;
+    while (file >> token) {
+        if (token == "r") {
+            initializeGame();
+            ++games;
+            continue;
+        }
+        if (games == 0) {
+            cout << path << ": tick before the first game reset" << endl;
+            return false;
+        }
+
+        char* end = nullptr;
+        long mask = strtol(token.c_str(), &end, 10);
+        if (*end != '\0' || mask < 0 || mask >= (1 << NUM_INPUTS)) {
+            cout << path << ": bad input at tick " << tick + 1 << endl;
+            return false;
+        }
+        for (int f = 0; f < NUM_HASH_FIELDS; ++f) {
+            file >> hex >> expected[f] >> dec;
+        }
+        if (!file) {
+            cout << path << ": truncated at tick " << tick + 1 << endl;
+            return false;
+        }
+        for (int i = 0; i < NUM_INPUTS; ++i) {
+            input[i] = (mask & (1 << i)) != 0;
+        }
+
+        updateGame(input);
+        ++tick;
+
+        bool diverged = false;
+        for (int f = 0; f < NUM_HASH_FIELDS; ++f) {
+            if (worldHash[f] != expected[f]) diverged = true;
+        }
+        if (diverged) {
+            cout << path << ": diverged at tick " << tick << " (game " << games << "), fields:";
+            for (int f = 0; f < NUM_HASH_FIELDS; ++f) {
+                if (worldHash[f] != expected[f]) cout << " " << HASH_FIELD_NAMES[f];
+            }
+            cout << endl;
+            return false;
+        }
+    }
+
+    cout << path << ": " << tick << " ticks in " << games << " games match" << endl;
+    return true;
+}
+
+bool verifyReplays(const char* path) {
+    vector<string> files;
+    error_code error;
+    if (filesystem::is_directory(path, error)) {
+        for (const filesystem::directory_entry& entry : filesystem::directory_iterator(path, error)) {
+            if (entry.path().extension() == ".replay") {
+                files.push_back(entry.path().string());
+            }
+        }
+        sort(files.begin(), files.end()); // Stable report order
+    } else {
+        files.push_back(path);
+    }
+    if (files.empty()) {
+        cout << path << ": no replays found" << endl;
+        return false;
+    }
+
+    int failed = 0;
+    for (const string& file : files) {
+        if (!verifyReplay(file)) failed++;
+    }
+    cout << files.size() - failed << " of " << files.size() << " replays match" << endl;
+    return failed == 0;
+}
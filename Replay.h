@@ -0,0 +1,25 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "Simulation.h"
+
+// Recorded sessions for regression checks. A replay holds the seed and the
+// mushroom field strategy, then one line per game reset ("r") and one per
+// tick: the input mask followed by the world hash fields expected after that
+// tick. Replaying the inputs must
+// reproduce every hash, so any change in simulation behaviour shows up at the
+// exact tick it first happens.
+
+// Starts writing a replay. randomState at this point is stored as the seed,
+// so call it before the first game is set up.
+bool startRecording(const char* path);
+void recordReset(); // Call whenever a new game is initialized
+void recordTick(const bool input[]); // Call right after updateGame
+void stopRecording();
+bool isRecording();
+
+// Replays one file, or every *.replay file in a directory, and prints the
+// first diverging tick and fields of each. Returns true if all of them match.
+bool verifyReplays(const char* path);
+
+#endif
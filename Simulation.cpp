@@ -0,0 +1,992 @@
+#include "Simulation.h"
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+
+// Game grid
+thread_local int centipedeGroup[CENTIPEDE_LENGTH] = {0};
+thread_local bool groupMoveLeft[MAX_GROUPS] = {true};
+thread_local int groupCount = 1;
+thread_local bool groupInPlayerArea[MAX_GROUPS] = {false};
+thread_local int groupHead[MAX_GROUPS] = {0};
+thread_local int segmentLag[CENTIPEDE_LENGTH] = {0};
+thread_local int centipedePath[MAX_GROUPS][PATH_LENGTH][3];
+thread_local int groupPathHead[MAX_GROUPS] = {0};
+thread_local int groupTurnX[MAX_GROUPS] = {0};
+thread_local int groupTurnVersion[MAX_GROUPS] = {0};
+thread_local int rowMushroomVersion[GRID_ROWS] = {0};
+
+// Game objects
+thread_local int mushroomGrid[NUM_MUSHROOMS][5];
+thread_local int centipedeGrid[CENTIPEDE_LENGTH][3];
+thread_local int player[2] = {};
+thread_local int partner[2] = {};
+thread_local int centipedeStep = CENTIPEDE_STEP;
+thread_local int segmentSpacing = SEGMENT_SPACING;
+thread_local int projectileCount = 0;
+thread_local int projectileX[MAX_PROJECTILES];
+thread_local int projectileY[MAX_PROJECTILES];
+thread_local int projectileDrift[MAX_PROJECTILES];
+thread_local int projectileOwner[MAX_PROJECTILES];
+thread_local int rapidFireLeft[NUM_FIGHTERS] = {0};
+thread_local int spreadLeft[NUM_FIGHTERS] = {0};
+thread_local int fireCooldown[NUM_FIGHTERS] = {0};
+
+// Game state
+thread_local int score = 0;
+thread_local bool moveLeft = true;
+thread_local bool playerWon = false;
+thread_local int headSpawnTicks = 0;
+thread_local int centipedeMoveTicks = 0;
+thread_local unsigned int randomState = 1;
+thread_local unsigned int worldTick = 0;
+thread_local GameEventSink gameEventSink = nullptr;
+thread_local unsigned long long collisionChecks = 0;
+
+thread_local unsigned int worldHash[NUM_HASH_FIELDS] = {0};
+thread_local bool mushroomHashDirty = true;
+thread_local bool centipedeHashDirty = true;
+
+thread_local int autopilotBudgetMicros = 2000;
+thread_local int autopilotLastMove = 4;
+thread_local int mushroomFieldStrategy = FIELD_SHUFFLE;
+thread_local Tuning tuning = DEFAULT_TUNING;
+thread_local bool coopGame = false;
+thread_local bool clearedFieldWins = true;
+
+static float rolloutAutopilotMove(int move, chrono::steady_clock::time_point deadline, bool& finished);
+static int findMushroomHit(int shot, const MushroomRows& rows);
+static int findSegmentHit(int shot, const SegmentRows& rows);
+static void hitMushroom(int shot, int mushroom);
+static void hitSegment(int shot, int segment);
+static void grantPowerUp(int fighter, int kind, int ticks);
+
+void initializeGame() {
+    // Initialize player position within bottom 5 rows
+    player[X] = (GRID_COLS / 2) * TILE_FIXED;
+    player[Y] = (GRID_ROWS - 5) * TILE_FIXED; // Spawn at top of bottom 5 rows
+    
+    // No shots in flight and no power-ups
+    projectileCount = 0;
+    for (int fighter = 0; fighter < NUM_FIGHTERS; ++fighter) {
+        rapidFireLeft[fighter] = 0;
+        spreadLeft[fighter] = 0;
+        fireCooldown[fighter] = 0;
+    }
+    
+    // In co-op the two fighters start a third of the way in from either side
+    if (coopGame) {
+        player[X] = (GRID_COLS / 3) * TILE_FIXED;
+        partner[X] = (GRID_COLS - GRID_COLS / 3) * TILE_FIXED;
+        partner[Y] = player[Y];
+    } else {
+        partner[X] = 0;
+        partner[Y] = 0;
+    }
+    
+    // Reset score
+    score = 0;
+    
+    // Initialize game objects
+    initializeMushrooms();
+    initializeCentipede();
+    
+    // Reset game state
+    moveLeft = true;
+    playerWon = false;
+    worldTick = 0;
+    updateWorldHash();
+    emitGameEvent(EVENT_GAME_STARTED, static_cast<int>(randomState), 0, 0);
+}
+
+void initializeMushrooms() {
+    // Mushrooms stay out of the player area
+    FieldSpec spec = {mushroomFieldStrategy, GRID_COLS, GRID_ROWS - MAX_PLAYER_ROWS, tuning.mushroomCount,
+                      MUSHROOM_SPACING, nullptr};
+    int tiles[NUM_MUSHROOMS];
+    int placed = generateMushroomField(spec, randomState, tiles);
+    
+    for (int i = 0; i < NUM_MUSHROOMS; ++i) {
+        mushroomGrid[i][EXISTS] = i < placed;
+        mushroomGrid[i][DAMAGE] = 0;
+        mushroomGrid[i][IS_POISONOUS] = false; // Initialize as non-poisonous
+        if (i < placed) {
+            mushroomGrid[i][X] = tiles[i] % GRID_COLS * TILE_FIXED;
+            mushroomGrid[i][Y] = tiles[i] / GRID_COLS * TILE_FIXED;
+            mushroomRowChanged(mushroomGrid[i][Y]);
+        } else {
+            mushroomGrid[i][X] = 0;
+            mushroomGrid[i][Y] = 0;
+            mushroomHashDirty = true;
+        }
+    }
+}
+
+void initializeCentipede() {
+    centipedeHashDirty = true;
+    // The path is recorded at this step, so the world keeps it until it ends
+    centipedeStep = tuning.centipedeStep;
+    segmentSpacing = segmentSpacingFor(centipedeStep);
+    
+    // Segment 0 is the tail on the right, the last segment leads
+    int headIndex = CENTIPEDE_LENGTH - 1;
+    int headX = (GRID_COLS - CENTIPEDE_LENGTH) * TILE_FIXED;
+    
+    // Fill the path as if the centipede had already walked in from the right
+    groupPathHead[0] = 0;
+    for (int k = 0; k < PATH_LENGTH; ++k) {
+        int entry = (groupPathHead[0] - k) & (PATH_LENGTH - 1);
+        centipedePath[0][entry][X] = headX + k * centipedeStep;
+        centipedePath[0][entry][Y] = 0;
+        centipedePath[0][entry][PATH_MOVE_LEFT] = true;
+    }
+    
+    for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
+        centipedeGrid[i][EXISTS] = true;
+        centipedeGroup[i] = 0; // All segments start in group 0
+        segmentLag[i] = headIndex - i;
+    }
+    followPath();
+    
+    groupHead[0] = headIndex;
+    groupTurnVersion[0] = -1;
+    groupMoveLeft[0] = true; // Initial group moves left
+    groupInPlayerArea[0] = false; // Start outside player area
+    groupCount = 1; // Start with one group
+    headSpawnTicks = 0; // Initialize spawn timer
+    centipedeMoveTicks = 0;
+}
+
+bool checkCollision(int x1, int y1, int w1, int h1, int x2, int y2, int w2, int h2) {
+    collisionChecks++;
+    return (x1 < x2 + w2 && x1 + w1 > x2 && y1 < y2 + h2 && y1 + h1 > y2);
+}
+
+void checkCentipedeMushroomCollisions() {
+    // Only heads can run into mushrooms, the body follows the path they cleared.
+    // Heads and mushrooms sit on whole rows, so only the head's own row can overlap.
+    MushroomRows rows;
+    snapshotMushroomRows(rows);
+    bool turned = false;
+    for (int group = 0; group < groupCount; ++group) {
+        int headIndex = groupHead[group];
+        if (headIndex == -1) continue;
+        int row = centipedeGrid[headIndex][Y] / TILE_FIXED;
+        for (int k = 0; k < rows.count[row]; ++k) {
+            int i = rows.index[row][k];
+            if (checkCollision(
+                centipedeGrid[headIndex][X], centipedeGrid[headIndex][Y], TILE_FIXED, TILE_FIXED,
+                mushroomGrid[i][X], mushroomGrid[i][Y], TILE_FIXED, TILE_FIXED)) {
+                turnGroup(group);
+                turned = true;
+                break;
+            }
+        }
+    }
+    if (turned) {
+        followPath();
+    }
+}
+
+bool checkPlayerCentipedeCollision(const int body[]) {
+    for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
+        if (centipedeGrid[i][EXISTS]) {
+            if (checkCollision(
+                body[X], body[Y], TILE_FIXED, TILE_FIXED,
+                centipedeGrid[i][X], centipedeGrid[i][Y], TILE_FIXED, TILE_FIXED)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool checkPlayerPoisonCollision(const int body[]) {
+    for (int i = 0; i < NUM_MUSHROOMS; ++i) {
+        if (mushroomGrid[i][EXISTS] && mushroomGrid[i][IS_POISONOUS]) {
+            if (checkCollision(
+                body[X], body[Y], TILE_FIXED, TILE_FIXED,
+                mushroomGrid[i][X], mushroomGrid[i][Y], TILE_FIXED, TILE_FIXED)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void moveProjectiles() {
+    // Every live shot in one pass over the packed arrays, with no branches
+    const int step = tuning.bulletStep;
+    for (int p = 0; p < projectileCount; ++p) {
+        projectileY[p] -= step;
+        projectileX[p] += projectileDrift[p];
+    }
+    
+    // Drop the shots that left the screen, keeping the rest in firing order
+    int kept = 0;
+    for (int p = 0; p < projectileCount; ++p) {
+        if (projectileY[p] >= -TILE_FIXED && projectileX[p] > -TILE_FIXED && projectileX[p] < SCREEN_WIDTH_FIXED) {
+            projectileX[kept] = projectileX[p];
+            projectileY[kept] = projectileY[p];
+            projectileDrift[kept] = projectileDrift[p];
+            projectileOwner[kept] = projectileOwner[p];
+            kept++;
+        }
+    }
+    projectileCount = kept;
+}
+
+void applyPlayerInput(int fighter, int body[], const bool input[]) {
+    const int playerSpeed = tuning.playerStep;
+    
+    // Player movement
+    if (input[INPUT_LEFT] && body[X] > 0) {
+        body[X] -= playerSpeed;
+    }
+    if (input[INPUT_RIGHT] && body[X] < SCREEN_WIDTH_FIXED - TILE_FIXED) {
+        body[X] += playerSpeed;
+    }
+    if (input[INPUT_UP] && 
+        body[Y] > (GRID_ROWS - MAX_PLAYER_ROWS) * TILE_FIXED) {
+        body[Y] -= playerSpeed;
+    }
+    if (input[INPUT_DOWN] && body[Y] < SCREEN_HEIGHT_FIXED - TILE_FIXED) {
+        body[Y] += playerSpeed;
+    }
+    
+    // Fire: once nothing of ours is in flight, or on the cooldown with rapid fire
+    bool ready;
+    if (rapidFireLeft[fighter] > 0) {
+        if (fireCooldown[fighter] > 0) fireCooldown[fighter]--;
+        ready = fireCooldown[fighter] == 0;
+    } else {
+        ready = true;
+        for (int p = 0; p < projectileCount; ++p) {
+            if (projectileOwner[p] == fighter) {
+                ready = false;
+                break;
+            }
+        }
+    }
+    if (input[INPUT_FIRE] && ready) {
+        int shots = spreadLeft[fighter] > 0 ? SPREAD_SHOTS : 1;
+        for (int s = 0; s < shots && projectileCount < MAX_PROJECTILES; ++s) {
+            int p = projectileCount++;
+            projectileX[p] = body[X];
+            projectileY[p] = body[Y] - TILE_FIXED;
+            projectileDrift[p] = (s - shots / 2) * SPREAD_DRIFT;
+            projectileOwner[p] = fighter;
+        }
+        fireCooldown[fighter] = tuning.rapidFireInterval;
+    }
+    
+    if (rapidFireLeft[fighter] > 0) rapidFireLeft[fighter]--;
+    if (spreadLeft[fighter] > 0) spreadLeft[fighter]--;
+}
+
+void splitCentipede(int hitSegmentIndex) {
+    centipedeHashDirty = true;
+    int hitX = centipedeGrid[hitSegmentIndex][X];
+    int hitY = centipedeGrid[hitSegmentIndex][Y];
+    int hitGroup = centipedeGroup[hitSegmentIndex];
+    int hitLag = segmentLag[hitSegmentIndex];
+
+    // Create poisonous mushroom at hit position
+    for (int i = 0; i < NUM_MUSHROOMS; i++) {
+        if (!mushroomGrid[i][EXISTS]) {
+            mushroomGrid[i][X] = hitX;
+            mushroomGrid[i][Y] = hitY;
+            mushroomGrid[i][EXISTS] = true;
+            mushroomGrid[i][DAMAGE] = 0;
+            mushroomGrid[i][IS_POISONOUS] = true; // Mark as poisonous
+            mushroomRowChanged(hitY);
+            break;
+        }
+    }
+
+    // Award points: more for head, less for body
+    bool isHead = (hitSegmentIndex == groupHead[hitGroup]);
+    int points = isHead ? 100 : 10;
+    score += points;
+    emitGameEvent(EVENT_SEGMENT_KILLED, hitSegmentIndex, isHead ? 1 : 0, hitGroup);
+    emitGameEvent(EVENT_SCORE, points, score, 0);
+
+    // Mark hit segment as non-existent
+    centipedeGrid[hitSegmentIndex][EXISTS] = false;
+
+    // The segment right behind the hit one leads whatever is left of the tail
+    int newHead = -1;
+    for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
+        if (centipedeGrid[i][EXISTS] && centipedeGroup[i] == hitGroup && segmentLag[i] > hitLag &&
+            (newHead == -1 || segmentLag[i] < segmentLag[newHead])) {
+            newHead = i;
+        }
+    }
+    if (newHead == -1) {
+        if (isHead) groupHead[hitGroup] = -1; // Nothing left of this group
+        return;
+    }
+
+    // A beheaded group keeps its slot; otherwise the tail needs a group of its own.
+    // With no free group the tail simply keeps following with a gap.
+    int newGroup = hitGroup;
+    if (!isHead) {
+        if (groupCount >= MAX_GROUPS) return;
+        newGroup = groupCount++;
+        memcpy(centipedePath[newGroup], centipedePath[hitGroup], sizeof(centipedePath[0]));
+        groupInPlayerArea[newGroup] = groupInPlayerArea[hitGroup]; // Inherit player area status
+    }
+
+    // Rewind the path so the new head reads the entry it is standing on
+    int shift = segmentLag[newHead];
+    groupPathHead[newGroup] = (groupPathHead[hitGroup] - shift * segmentSpacing) & (PATH_LENGTH - 1);
+    for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
+        if (centipedeGrid[i][EXISTS] && centipedeGroup[i] == hitGroup && segmentLag[i] > hitLag) {
+            centipedeGroup[i] = newGroup;
+            segmentLag[i] -= shift;
+        }
+    }
+    groupHead[newGroup] = newHead;
+    groupMoveLeft[newGroup] = centipedePath[newGroup][groupPathHead[newGroup]][PATH_MOVE_LEFT];
+    groupTurnVersion[newGroup] = -1;
+    emitGameEvent(EVENT_SPLIT, hitGroup, newGroup, newHead);
+}
+
+void spawnNewHead() {
+    centipedeHashDirty = true;
+    // Find an unused segment slot
+    int newSegmentIndex = -1;
+    for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
+        if (!centipedeGrid[i][EXISTS]) {
+            newSegmentIndex = i;
+            break;
+        }
+    }
+    if (newSegmentIndex == -1 || groupCount >= MAX_GROUPS) return; // No space or too many groups
+
+    // Create new group for the head
+    int newGroup = groupCount++;
+    groupInPlayerArea[newGroup] = true; // Head spawns in player area
+    groupMoveLeft[newGroup] = nextRandom() % 2; // Random direction (true = left, false = right)
+
+    // Set position in player area (rows 25-29)
+    int newRow = (nextRandom() % MAX_PLAYER_ROWS) + (GRID_ROWS - MAX_PLAYER_ROWS);
+    centipedeGrid[newSegmentIndex][Y] = newRow * TILE_FIXED;
+    centipedeGrid[newSegmentIndex][X] = groupMoveLeft[newGroup] ? SCREEN_WIDTH_FIXED : -TILE_FIXED;
+    centipedeGrid[newSegmentIndex][EXISTS] = true;
+    centipedeGroup[newSegmentIndex] = newGroup;
+    segmentLag[newSegmentIndex] = 0;
+    groupHead[newGroup] = newSegmentIndex;
+    groupTurnVersion[newGroup] = -1;
+    groupPathHead[newGroup] = 0;
+    centipedePath[newGroup][0][X] = centipedeGrid[newSegmentIndex][X];
+    centipedePath[newGroup][0][Y] = centipedeGrid[newSegmentIndex][Y];
+    centipedePath[newGroup][0][PATH_MOVE_LEFT] = groupMoveLeft[newGroup];
+    emitGameEvent(EVENT_HEAD_SPAWNED, newGroup, newSegmentIndex, newRow);
+}
+
+void checkProjectileCollisions() {
+    if (projectileCount == 0) return;
+    
+    // Broadphase shared by every shot: mushrooms and segments sit on whole
+    // rows, so each is bucketed by row once and a shot tests only the rows
+    // its path this tick overlaps
+    MushroomRows mushroomRows;
+    snapshotMushroomRows(mushroomRows);
+    SegmentRows segmentRows;
+    snapshotSegmentRows(segmentRows);
+    
+    // Shots resolve in firing order; a shot that hits anything is used up
+    int kept = 0;
+    for (int p = 0; p < projectileCount; ++p) {
+        // The shot stops at whatever its path reaches first, a mushroom on a tie
+        int mushroom = findMushroomHit(p, mushroomRows);
+        int segment = findSegmentHit(p, segmentRows);
+        if (segment != -1 && (mushroom == -1 || centipedeGrid[segment][Y] > mushroomGrid[mushroom][Y])) {
+            hitSegment(p, segment);
+            snapshotMushroomRows(mushroomRows); // The kill dropped poison mushrooms
+            continue;
+        }
+        if (mushroom != -1) {
+            hitMushroom(p, mushroom);
+            continue;
+        }
+        projectileX[kept] = projectileX[p];
+        projectileY[kept] = projectileY[p];
+        projectileDrift[kept] = projectileDrift[p];
+        projectileOwner[kept] = projectileOwner[p];
+        kept++;
+    }
+    projectileCount = kept;
+}
+
+// A shot is tested along the whole path it moved this tick, from its tile now
+// down to where it was, so no speed lets it pass through a target
+static inline int shotPathHeight() {
+    return TILE_FIXED + tuning.bulletStep;
+}
+
+// First and last grid row a shot's path overlaps, before clipping to the grid
+static inline int firstShotRow(int y) {
+    return (y + TILE_FIXED) / TILE_FIXED - 1; // Shots reach up to -TILE_FIXED
+}
+static inline int lastShotRow(int y) {
+    return (y + shotPathHeight() - 1 + TILE_FIXED) / TILE_FIXED - 1;
+}
+
+// The lowest row is reached first; within it the lowest-numbered mushroom
+static int findMushroomHit(int shot, const MushroomRows& rows) {
+    int top = max(firstShotRow(projectileY[shot]), 0);
+    int bottom = min(lastShotRow(projectileY[shot]), GRID_ROWS - 1);
+    for (int row = bottom; row >= top; --row) {
+        int hit = -1;
+        for (int k = 0; k < rows.count[row]; ++k) {
+            int i = rows.index[row][k];
+            if (mushroomGrid[i][EXISTS] && (hit == -1 || i < hit) &&
+                checkCollision(projectileX[shot], projectileY[shot], TILE_FIXED, shotPathHeight(),
+                               mushroomGrid[i][X], mushroomGrid[i][Y], TILE_FIXED, TILE_FIXED)) {
+                hit = i;
+            }
+        }
+        if (hit != -1) return hit;
+    }
+    return -1;
+}
+
+static int findSegmentHit(int shot, const SegmentRows& rows) {
+    int top = max(firstShotRow(projectileY[shot]), 0);
+    int bottom = min(lastShotRow(projectileY[shot]), GRID_ROWS - 1);
+    for (int row = bottom; row >= top; --row) {
+        int hit = -1;
+        for (int k = 0; k < rows.count[row]; ++k) {
+            int i = rows.index[row][k];
+            if (centipedeGrid[i][EXISTS] && (hit == -1 || i < hit) &&
+                checkCollision(projectileX[shot], projectileY[shot], TILE_FIXED, shotPathHeight(),
+                               centipedeGrid[i][X], centipedeGrid[i][Y], TILE_FIXED, TILE_FIXED)) {
+                hit = i;
+            }
+        }
+        if (hit != -1) return hit;
+    }
+    return -1;
+}
+
+static void hitMushroom(int shot, int hit) {
+    // Increase damage level
+    mushroomGrid[hit][DAMAGE]++;
+    mushroomHashDirty = true;
+    
+    // Check if mushroom should be destroyed
+    if (mushroomGrid[hit][DAMAGE] >= 4) {
+        mushroomGrid[hit][EXISTS] = false;
+        mushroomRowChanged(mushroomGrid[hit][Y]);
+        score += 1;
+        emitGameEvent(EVENT_MUSHROOM_DESTROYED, hit, mushroomGrid[hit][X] >> FIXED_SHIFT,
+                      mushroomGrid[hit][Y] >> FIXED_SHIFT);
+        emitGameEvent(EVENT_SCORE, 1, score, 0);
+        if (mushroomGrid[hit][IS_POISONOUS]) {
+            grantPowerUp(projectileOwner[shot], POWER_UP_SPREAD, tuning.spreadTicks);
+        }
+    }
+}
+
+static void hitSegment(int shot, int hit) {
+    // Spawn poisonous mushroom at hit position
+    for (int j = 0; j < NUM_MUSHROOMS; j++) {
+        if (!mushroomGrid[j][EXISTS]) {
+            mushroomGrid[j][X] = centipedeGrid[hit][X];
+            mushroomGrid[j][Y] = centipedeGrid[hit][Y];
+            mushroomGrid[j][EXISTS] = true;
+            mushroomGrid[j][DAMAGE] = 0;
+            mushroomGrid[j][IS_POISONOUS] = true;
+            mushroomRowChanged(mushroomGrid[j][Y]);
+            break;
+        }
+    }
+    
+    // Split the centipede
+    bool isHead = (hit == groupHead[centipedeGroup[hit]]);
+    splitCentipede(hit);
+    if (isHead) {
+        grantPowerUp(projectileOwner[shot], POWER_UP_RAPID_FIRE, tuning.rapidFireTicks);
+    }
+    
+    // Check if all segments are eliminated
+    bool allEliminated = true;
+    for (int j = 0; j < CENTIPEDE_LENGTH; ++j) {
+        if (centipedeGrid[j][EXISTS]) {
+            allEliminated = false;
+            break;
+        }
+    }
+    if (allEliminated) {
+        playerWon = true; // Caller ends the round
+    }
+}
+
+static void grantPowerUp(int fighter, int kind, int ticks) {
+    if (ticks == 0) return; // Turned off in the tuning
+    if (kind == POWER_UP_RAPID_FIRE) {
+        if (rapidFireLeft[fighter] == 0) fireCooldown[fighter] = 0; // First shot straight away
+        rapidFireLeft[fighter] = ticks;
+    } else {
+        spreadLeft[fighter] = ticks;
+    }
+    emitGameEvent(EVENT_POWER_UP, fighter, kind, ticks);
+}
+
+void moveCentipede() {
+    centipedeHashDirty = true;
+    MushroomRows rows;
+    snapshotMushroomRows(rows);
+
+    // Groups move serially, in order: with at most MAX_GROUPS of them a whole
+    // step costs less than waking a worker, so threads split worlds instead
+    // (VectorEnv, the spectator view). A mushroom dropped here bumps its row's
+    // version, so a later group's bound on that row is redone before it is used.
+    for (int group = 0; group < groupCount; ++group) {
+        int headIndex = groupHead[group];
+        if (headIndex == -1) continue;
+
+        // Check if group is entering player area
+        if (!groupInPlayerArea[group] && centipedeGrid[headIndex][Y] >= (GRID_ROWS - MAX_PLAYER_ROWS) * TILE_FIXED) {
+            groupInPlayerArea[group] = true;
+            // Spawn poisonous mushroom at head position
+            for (int i = 0; i < NUM_MUSHROOMS; i++) {
+                if (!mushroomGrid[i][EXISTS]) {
+                    mushroomGrid[i][X] = centipedeGrid[headIndex][X];
+                    mushroomGrid[i][Y] = centipedeGrid[headIndex][Y];
+                    mushroomGrid[i][EXISTS] = true;
+                    mushroomGrid[i][DAMAGE] = 0;
+                    mushroomGrid[i][IS_POISONOUS] = true;
+                    mushroomRowChanged(mushroomGrid[i][Y]);
+                    addToMushroomRows(rows, i);
+                    break;
+                }
+            }
+        }
+
+        // Only the head decides where to go: turn at the end of its run along the row
+        int row = centipedeGrid[headIndex][Y] / TILE_FIXED;
+        if (groupTurnVersion[group] != rowMushroomVersion[row]) {
+            updateTurnBound(group, rows);
+        }
+        int nextX = centipedeGrid[headIndex][X] + (groupMoveLeft[group] ? -centipedeStep : centipedeStep);
+        bool blocked = groupMoveLeft[group] ? nextX < groupTurnX[group] : nextX > groupTurnX[group];
+
+        if (blocked) {
+            turnGroup(group);
+        } else {
+            centipedeGrid[headIndex][X] = nextX;
+            recordHeadPosition(group);
+        }
+    }
+
+    followPath();
+}
+
+void turnGroup(int group) {
+    centipedeHashDirty = true;
+    int headIndex = groupHead[group];
+    groupMoveLeft[group] = !groupMoveLeft[group];
+    groupTurnVersion[group] = -1; // New row and direction, new run
+
+    // Drop a row; in the player area the bottom row wraps to the top of the area
+    int nextRow = centipedeGrid[headIndex][Y] / TILE_FIXED + 1;
+    if (groupInPlayerArea[group] && nextRow > GRID_ROWS - 1) {
+        nextRow = GRID_ROWS - MAX_PLAYER_ROWS;
+    }
+    centipedeGrid[headIndex][Y] = nextRow * TILE_FIXED;
+    recordHeadPosition(group);
+}
+
+void updateTurnBound(int group, const MushroomRows& rows) {
+    // The first X at which the head would overlap a mushroom or leave the screen.
+    // Mushrooms sit on whole rows, so only the head's own row matters.
+    int headIndex = groupHead[group];
+    int headX = centipedeGrid[headIndex][X];
+    int headY = centipedeGrid[headIndex][Y];
+    int row = headY / TILE_FIXED;
+    int bound;
+    if (groupMoveLeft[group]) {
+        bound = 0;
+        for (int k = 0; k < rows.count[row]; ++k) {
+            int i = rows.index[row][k];
+            if (mushroomGrid[i][X] < headX - centipedeStep + TILE_FIXED &&
+                mushroomGrid[i][X] + TILE_FIXED > bound) {
+                bound = mushroomGrid[i][X] + TILE_FIXED;
+            }
+        }
+    } else {
+        bound = SCREEN_WIDTH_FIXED - TILE_FIXED;
+        for (int k = 0; k < rows.count[row]; ++k) {
+            int i = rows.index[row][k];
+            if (mushroomGrid[i][X] > headX + centipedeStep - TILE_FIXED &&
+                mushroomGrid[i][X] - TILE_FIXED < bound) {
+                bound = mushroomGrid[i][X] - TILE_FIXED;
+            }
+        }
+    }
+    groupTurnX[group] = bound;
+    groupTurnVersion[group] = rowMushroomVersion[row];
+}
+
+void snapshotMushroomRows(MushroomRows& rows) {
+    memset(rows.count, 0, sizeof(rows.count));
+    for (int i = 0; i < NUM_MUSHROOMS; ++i) {
+        if (mushroomGrid[i][EXISTS]) {
+            addToMushroomRows(rows, i);
+        }
+    }
+}
+
+void snapshotSegmentRows(SegmentRows& rows) {
+    memset(rows.count, 0, sizeof(rows.count));
+    for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
+        int row = centipedeGrid[i][Y] / TILE_FIXED;
+        if (centipedeGrid[i][EXISTS] && row >= 0 && row < GRID_ROWS) {
+            rows.index[row][rows.count[row]++] = i;
+        }
+    }
+}
+
+void addToMushroomRows(MushroomRows& rows, int mushroom) {
+    int row = mushroomGrid[mushroom][Y] / TILE_FIXED;
+    if (row >= 0 && row < GRID_ROWS) {
+        rows.index[row][rows.count[row]++] = mushroom;
+    }
+}
+
+void mushroomRowChanged(int y) {
+    mushroomHashDirty = true;
+    int row = y / TILE_FIXED;
+    if (row >= 0 && row < GRID_ROWS) {
+        rowMushroomVersion[row]++;
+    }
+}
+
+void recordHeadPosition(int group) {
+    int headIndex = groupHead[group];
+    int entry = (groupPathHead[group] + 1) & (PATH_LENGTH - 1);
+    centipedePath[group][entry][X] = centipedeGrid[headIndex][X];
+    centipedePath[group][entry][Y] = centipedeGrid[headIndex][Y];
+    centipedePath[group][entry][PATH_MOVE_LEFT] = groupMoveLeft[group];
+    groupPathHead[group] = entry;
+}
+
+void followPath() {
+    centipedeHashDirty = true;
+    // Each segment sits a fixed number of path entries behind its head
+    for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
+        if (centipedeGrid[i][EXISTS]) {
+            int group = centipedeGroup[i];
+            int entry = (groupPathHead[group] - segmentLag[i] * segmentSpacing) & (PATH_LENGTH - 1);
+            centipedeGrid[i][X] = centipedePath[group][entry][X];
+            centipedeGrid[i][Y] = centipedePath[group][entry][Y];
+        }
+    }
+}
+
+int updateGame(const bool input[]) {
+    static const bool NO_INPUT[NUM_INPUTS] = {false};
+    return updateGame(input, NO_INPUT);
+}
+
+int updateGame(const bool input[], const bool partnerInput[]) {
+    worldTick++;
+    applyPlayerInput(FIGHTER_PLAYER, player, input);
+    if (coopGame) {
+        applyPlayerInput(FIGHTER_PARTNER, partner, partnerInput);
+    }
+    
+    if (++centipedeMoveTicks >= tuning.centipedeMoveTicks) {
+        moveCentipede();
+        centipedeMoveTicks = 0;
+    }
+    
+    moveProjectiles();
+    
+    // Spawn new heads if any group is in player area
+    bool anyGroupInPlayerArea = false;
+    for (int i = 0; i < groupCount; ++i) {
+        if (groupInPlayerArea[i]) {
+            anyGroupInPlayerArea = true;
+            break;
+        }
+    }
+    headSpawnTicks++;
+    if (anyGroupInPlayerArea && headSpawnTicks >= tuning.headSpawnTicks) {
+        spawnNewHead();
+        headSpawnTicks = 0;
+    }
+    
+    checkCentipedeMushroomCollisions();
+    checkProjectileCollisions();
+    
+    updateWorldHash();
+    
+    if (playerWon) {
+        if (clearedFieldWins) emitGameEvent(EVENT_PLAYER_WON, score, 0, 0);
+        return TICK_PLAYER_WON;
+    }
+    if (checkPlayerCentipedeCollision(player) || (coopGame && checkPlayerCentipedeCollision(partner))) {
+        emitGameEvent(EVENT_PLAYER_DIED, score, 0, 0);
+        return TICK_PLAYER_DIED;
+    }
+    return TICK_RUNNING;
+}
+
+void setTuning(const Tuning& next) {
+    tuning = next; // A new centipede step waits for the next initializeGame
+}
+
+void updateUnwatchedWorld() {
+    // Only the centipedes move; the player and projectiles stand still and nothing scores
+    worldTick++;
+    moveCentipede();
+    checkCentipedeMushroomCollisions();
+}
+
+static unsigned int mixHash(unsigned int hash) {
+    // Murmur3 finalizer
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+// Each value is weighted by its own odd multiplier, so a single changed value
+// always changes the sum, and the loops vectorize
+static unsigned int hashInts(unsigned int hash, const int* values, int count) {
+    unsigned int sum = 0;
+    for (int i = 0; i < count; ++i) {
+        sum += static_cast<unsigned int>(values[i]) * (2654435761u + 2u * i);
+    }
+    return mixHash(hash + sum);
+}
+
+static unsigned int hashBools(unsigned int hash, const bool* values, int count) {
+    unsigned int sum = 0;
+    for (int i = 0; i < count; ++i) {
+        sum += (values[i] ? 1u : 0u) * (2654435761u + 2u * i);
+    }
+    return mixHash(hash + sum);
+}
+
+void updateWorldHash() {
+    const unsigned int HASH_SEED = 0x9e3779b9u;
+    unsigned int hash;
+    
+    // Each fighter with its power-ups; the partner only plays in co-op
+    int fighters = coopGame ? NUM_FIGHTERS : 1;
+    hash = hashInts(HASH_SEED, player, 2);
+    if (coopGame) {
+        hash = hashInts(hash, partner, 2);
+    }
+    hash = hashInts(hash, rapidFireLeft, fighters);
+    hash = hashInts(hash, spreadLeft, fighters);
+    worldHash[HASH_PLAYER] = hashInts(hash, fireCooldown, fighters);
+    
+    hash = hashInts(HASH_SEED, &projectileCount, 1);
+    hash = hashInts(hash, projectileX, projectileCount);
+    hash = hashInts(hash, projectileY, projectileCount);
+    hash = hashInts(hash, projectileDrift, projectileCount);
+    worldHash[HASH_PROJECTILES] = hashInts(hash, projectileOwner, projectileCount);
+    
+    // The centipede only changes on the ticks it moves, turns or is hit
+    if (centipedeHashDirty) {
+        hash = hashInts(HASH_SEED, &centipedeGrid[0][0], CENTIPEDE_LENGTH * 3);
+        hash = hashInts(hash, centipedeGroup, CENTIPEDE_LENGTH);
+        worldHash[HASH_CENTIPEDE] = hashInts(hash, segmentLag, CENTIPEDE_LENGTH);
+        
+        // Slots past groupCount hold stale data and are left out
+        hash = hashInts(HASH_SEED, &groupCount, 1);
+        hash = hashInts(hash, groupHead, groupCount);
+        hash = hashInts(hash, groupPathHead, groupCount);
+        hash = hashBools(hash, groupMoveLeft, groupCount);
+        worldHash[HASH_GROUPS] = hashBools(hash, groupInPlayerArea, groupCount);
+        centipedeHashDirty = false;
+    }
+    
+    // The mushroom field is the largest block and rarely changes
+    if (mushroomHashDirty) {
+        worldHash[HASH_MUSHROOMS] = hashInts(HASH_SEED, &mushroomGrid[0][0], NUM_MUSHROOMS * 5);
+        mushroomHashDirty = false;
+    }
+    
+    hash = hashInts(HASH_SEED, &score, 1);
+    worldHash[HASH_SCORE] = hashBools(hash, &playerWon, 1);
+    
+    int timers[3] = {headSpawnTicks, centipedeMoveTicks, static_cast<int>(randomState)};
+    worldHash[HASH_TIMERS] = hashInts(HASH_SEED, timers, 3);
+}
+
+unsigned int worldHashTotal() {
+    return hashInts(0x9e3779b9u, reinterpret_cast<const int*>(worldHash), NUM_HASH_FIELDS);
+}
+
+int nextRandom() {
+    // xorshift32: cheap, and its whole state fits in the world snapshot
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return static_cast<int>(randomState & 0x7fffffff);
+}
+
+void saveWorldState(WorldState& state) {
+    memcpy(state.mushroomGrid, mushroomGrid, sizeof(mushroomGrid));
+    memcpy(state.centipedeGrid, centipedeGrid, sizeof(centipedeGrid));
+    memcpy(state.centipedeGroup, centipedeGroup, sizeof(centipedeGroup));
+    memcpy(state.groupMoveLeft, groupMoveLeft, sizeof(groupMoveLeft));
+    memcpy(state.groupInPlayerArea, groupInPlayerArea, sizeof(groupInPlayerArea));
+    memcpy(state.groupHead, groupHead, sizeof(groupHead));
+    memcpy(state.segmentLag, segmentLag, sizeof(segmentLag));
+    memcpy(state.groupPathHead, groupPathHead, sizeof(groupPathHead));
+    memcpy(state.groupTurnX, groupTurnX, sizeof(groupTurnX));
+    memcpy(state.groupTurnVersion, groupTurnVersion, sizeof(groupTurnVersion));
+    memcpy(state.rowMushroomVersion, rowMushroomVersion, sizeof(rowMushroomVersion));
+    memcpy(state.centipedePath, centipedePath, sizeof(centipedePath[0]) * groupCount); // Unused groups are stale
+    memcpy(state.player, player, sizeof(player));
+    memcpy(state.partner, partner, sizeof(partner));
+    state.centipedeStep = centipedeStep;
+    memcpy(state.projectileX, projectileX, sizeof(projectileX[0]) * projectileCount); // Past the count is stale
+    memcpy(state.projectileY, projectileY, sizeof(projectileY[0]) * projectileCount);
+    memcpy(state.projectileDrift, projectileDrift, sizeof(projectileDrift[0]) * projectileCount);
+    memcpy(state.projectileOwner, projectileOwner, sizeof(projectileOwner[0]) * projectileCount);
+    memcpy(state.rapidFireLeft, rapidFireLeft, sizeof(rapidFireLeft));
+    memcpy(state.spreadLeft, spreadLeft, sizeof(spreadLeft));
+    memcpy(state.fireCooldown, fireCooldown, sizeof(fireCooldown));
+    state.projectileCount = projectileCount;
+    state.groupCount = groupCount;
+    state.score = score;
+    state.playerWon = playerWon;
+    state.headSpawnTicks = headSpawnTicks;
+    state.centipedeMoveTicks = centipedeMoveTicks;
+    state.randomState = randomState;
+    state.worldTick = worldTick;
+}
+
+void loadWorldState(const WorldState& state) {
+    memcpy(mushroomGrid, state.mushroomGrid, sizeof(mushroomGrid));
+    memcpy(centipedeGrid, state.centipedeGrid, sizeof(centipedeGrid));
+    memcpy(centipedeGroup, state.centipedeGroup, sizeof(centipedeGroup));
+    memcpy(groupMoveLeft, state.groupMoveLeft, sizeof(groupMoveLeft));
+    memcpy(groupInPlayerArea, state.groupInPlayerArea, sizeof(groupInPlayerArea));
+    memcpy(groupHead, state.groupHead, sizeof(groupHead));
+    memcpy(segmentLag, state.segmentLag, sizeof(segmentLag));
+    memcpy(groupPathHead, state.groupPathHead, sizeof(groupPathHead));
+    memcpy(groupTurnX, state.groupTurnX, sizeof(groupTurnX));
+    memcpy(groupTurnVersion, state.groupTurnVersion, sizeof(groupTurnVersion));
+    memcpy(rowMushroomVersion, state.rowMushroomVersion, sizeof(rowMushroomVersion));
+    memcpy(centipedePath, state.centipedePath, sizeof(centipedePath[0]) * state.groupCount);
+    memcpy(player, state.player, sizeof(player));
+    memcpy(partner, state.partner, sizeof(partner));
+    centipedeStep = state.centipedeStep;
+    segmentSpacing = segmentSpacingFor(centipedeStep);
+    memcpy(projectileX, state.projectileX, sizeof(projectileX[0]) * state.projectileCount);
+    memcpy(projectileY, state.projectileY, sizeof(projectileY[0]) * state.projectileCount);
+    memcpy(projectileDrift, state.projectileDrift, sizeof(projectileDrift[0]) * state.projectileCount);
+    memcpy(projectileOwner, state.projectileOwner, sizeof(projectileOwner[0]) * state.projectileCount);
+    memcpy(rapidFireLeft, state.rapidFireLeft, sizeof(rapidFireLeft));
+    memcpy(spreadLeft, state.spreadLeft, sizeof(spreadLeft));
+    memcpy(fireCooldown, state.fireCooldown, sizeof(fireCooldown));
+    projectileCount = state.projectileCount;
+    groupCount = state.groupCount;
+    score = state.score;
+    playerWon = state.playerWon;
+    headSpawnTicks = state.headSpawnTicks;
+    centipedeMoveTicks = state.centipedeMoveTicks;
+    randomState = state.randomState;
+    worldTick = state.worldTick;
+    mushroomHashDirty = true;
+    centipedeHashDirty = true;
+}
+
+int findGroupHead(int group) {
+    return groupHead[group];
+}
+
+void chooseAutopilotInput(bool input[]) {
+    chrono::steady_clock::time_point deadline =
+        chrono::steady_clock::now() + chrono::microseconds(autopilotBudgetMicros);
+    
+    WorldState root;
+    saveWorldState(root);
+    GameEventSink sink = gameEventSink;
+    gameEventSink = nullptr; // Rollouts are not real events
+    
+    // Try the previous move first so the bot keeps a steady course when the budget
+    // runs out; if even that rollout does not fit, the previous move is kept
+    int bestMove = autopilotLastMove;
+    float bestValue = 0.0f;
+    bool haveBest = false;
+    for (int n = 0; n < AUTOPILOT_MOVES; ++n) {
+        int move = (autopilotLastMove + n) % AUTOPILOT_MOVES;
+        bool finished = true;
+        float value = rolloutAutopilotMove(move, deadline, finished);
+        loadWorldState(root);
+        if (!finished) {
+            break;
+        }
+        if (!haveBest || value > bestValue) {
+            bestValue = value;
+            bestMove = move;
+            haveBest = true;
+        }
+    }
+    autopilotLastMove = bestMove;
+    gameEventSink = sink;
+    
+    input[INPUT_LEFT] = bestMove % 3 == 0;
+    input[INPUT_RIGHT] = bestMove % 3 == 2;
+    input[INPUT_UP] = bestMove / 3 == 0;
+    input[INPUT_DOWN] = bestMove / 3 == 2;
+    input[INPUT_FIRE] = true;
+}
+
+static float rolloutAutopilotMove(int move, chrono::steady_clock::time_point deadline, bool& finished) {
+    const float DEATH_PENALTY = 1000000.0f;
+    const float WIN_BONUS = 1000000.0f;
+    int startScore = score;
+    bool input[NUM_INPUTS] = {false};
+    input[INPUT_FIRE] = true;
+    
+    for (int tick = 0; tick < AUTOPILOT_HORIZON_TICKS; ++tick) {
+        // Checked often enough that a slow tick cannot carry it far past the budget
+        if ((tick & 7) == 0 && chrono::steady_clock::now() > deadline) {
+            finished = false;
+            return 0.0f;
+        }
+        
+        // Hold the candidate move, then stand still and keep firing
+        bool committed = tick < AUTOPILOT_COMMIT_TICKS;
+        input[INPUT_LEFT] = committed && move % 3 == 0;
+        input[INPUT_RIGHT] = committed && move % 3 == 2;
+        input[INPUT_UP] = committed && move / 3 == 0;
+        input[INPUT_DOWN] = committed && move / 3 == 2;
+        
+        int outcome = updateGame(input);
+        if (outcome == TICK_PLAYER_WON) {
+            return WIN_BONUS - tick;
+        }
+        if (outcome == TICK_PLAYER_DIED || checkPlayerPoisonCollision(player)) {
+            return -DEATH_PENALTY + tick; // Later deaths are less bad
+        }
+    }
+    
+    // Survived: prefer points (heads are worth the most), then standing under a head
+    int nearestHead = SCREEN_WIDTH_FIXED;
+    for (int group = 0; group < groupCount; ++group) {
+        int headIndex = findGroupHead(group);
+        if (headIndex != -1) {
+            int distance = centipedeGrid[headIndex][X] - player[X];
+            if (distance < 0) distance = -distance;
+            if (distance < nearestHead) nearestHead = distance;
+        }
+    }
+    return (score - startScore) * 10.0f - static_cast<float>(nearestHead) / TILE_FIXED;
+}
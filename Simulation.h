@@ -0,0 +1,302 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+// Game simulation shared by the SFML front end, headless runs and the vector
+// environment. Nothing in here depends on SFML.
+//
+// The world lives in thread_local globals: every thread owns one world, and
+// other worlds are swapped in and out with saveWorldState/loadWorldState.
+
+#include "MushroomField.h"
+
+// Game constants with improved naming
+const int SCREEN_WIDTH = 960;
+const int SCREEN_HEIGHT = 960;
+const int TILE_SIZE = 32;
+const int GRID_COLS = SCREEN_WIDTH / TILE_SIZE;
+const int GRID_ROWS = SCREEN_HEIGHT / TILE_SIZE;
+const int MAX_PLAYER_ROWS = 5; // Bottom 5 rows
+const int NUM_MUSHROOMS = 30;
+const int MUSHROOM_SPACING = 2; // FIELD_SPACED keeps mushrooms off each other's neighbouring tiles
+const int CENTIPEDE_LENGTH = 12;
+const int MAX_GROUPS = 10; // Maximum number of centipede groups
+
+// Fixed-point world coordinates: every position and speed in the simulation is
+// a whole number of 1/256 pixels, so runs are bit-exact on any compiler or CPU.
+// Convert with toPixels only when drawing.
+const int FIXED_SHIFT = 8;
+const int FIXED_ONE = 1 << FIXED_SHIFT;
+const int TILE_FIXED = TILE_SIZE * FIXED_ONE;
+const int SCREEN_WIDTH_FIXED = SCREEN_WIDTH * FIXED_ONE;
+const int SCREEN_HEIGHT_FIXED = SCREEN_HEIGHT * FIXED_ONE;
+
+inline float toPixels(int fixed) {
+    return static_cast<float>(fixed) / FIXED_ONE;
+}
+
+// The simulation advances in fixed ticks; speeds are per tick.
+// These are the defaults of the tuning below.
+const int TICKS_PER_SECOND = 120;
+const int PLAYER_STEP = 1200 * FIXED_ONE / TICKS_PER_SECOND; // 1200 px/s
+const int BULLET_STEP = 5000 * FIXED_ONE / TICKS_PER_SECOND; // 5000 px/s
+const int CENTIPEDE_STEP = 3 * FIXED_ONE; // Distance a head moves per step
+const int CENTIPEDE_MOVE_TICKS = 2; // Ticks between centipede steps (180 px/s)
+const int HEAD_SPAWN_TICKS = 5 * TICKS_PER_SECOND; // Ticks between head spawns
+const int SEGMENT_SPACING = (TILE_FIXED + CENTIPEDE_STEP - 1) / CENTIPEDE_STEP; // Path entries between neighbours
+const int PATH_LENGTH = 128; // Path entries kept per group, a power of two
+static_assert((PATH_LENGTH & (PATH_LENGTH - 1)) == 0, "PATH_LENGTH must be a power of two");
+static_assert(PATH_LENGTH > (CENTIPEDE_LENGTH - 1) * SEGMENT_SPACING, "path too short for the tail");
+const int RAPID_FIRE_TICKS = 5 * TICKS_PER_SECOND; // Rapid fire granted by killing a head
+const int SPREAD_TICKS = 5 * TICKS_PER_SECOND; // Spread shot granted by destroying a poison mushroom
+const int RAPID_FIRE_INTERVAL = 8; // Ticks between rapid-fire shots (15 shots/s)
+
+// Projectiles. Without power-ups a fighter has one shot in flight at a time;
+// with rapid fire it shoots every rapidFireInterval ticks however many are in
+// flight, and with spread every shot is a fan of SPREAD_SHOTS.
+const int MAX_PROJECTILES = 48; // Shared by both fighters
+const int SPREAD_SHOTS = 3;
+const int SPREAD_DRIFT = 800 * FIXED_ONE / TICKS_PER_SECOND; // Sideways speed of the outer shots, 800 px/s
+
+// Fighters, indexing the per-fighter power-up state
+const int FIGHTER_PLAYER = 0;
+const int FIGHTER_PARTNER = 1; // Co-op only
+const int NUM_FIGHTERS = 2;
+
+// Gameplay knobs that can change while the game runs (see Tuning.h). The
+// simulation reads them from here, never from the constants above.
+struct Tuning {
+    int playerStep; // Per tick
+    int bulletStep; // Per tick
+    int centipedeStep; // Per centipede step, from the next game on
+    int centipedeMoveTicks;
+    int headSpawnTicks;
+    int mushroomCount; // Mushrooms in a new field, at most NUM_MUSHROOMS
+    int rapidFireTicks; // 0 = power-up off
+    int spreadTicks; // 0 = power-up off
+    int rapidFireInterval;
+};
+const Tuning DEFAULT_TUNING = {PLAYER_STEP, BULLET_STEP, CENTIPEDE_STEP,
+                               CENTIPEDE_MOVE_TICKS, HEAD_SPAWN_TICKS, NUM_MUSHROOMS,
+                               RAPID_FIRE_TICKS, SPREAD_TICKS, RAPID_FIRE_INTERVAL};
+
+inline int segmentSpacingFor(int step) {
+    return (TILE_FIXED + step - 1) / step;
+}
+
+// Constants for array indices
+const int X = 0;
+const int Y = 1;
+const int EXISTS = 2;
+const int DAMAGE = 3;  // For mushrooms
+const int IS_POISONOUS = 4;
+const int PATH_MOVE_LEFT = 2; // For path entries: direction the head was moving
+
+// Player input flags, filled from the keyboard or from the autopilot
+const int INPUT_LEFT = 0;
+const int INPUT_RIGHT = 1;
+const int INPUT_UP = 2;
+const int INPUT_DOWN = 3;
+const int INPUT_FIRE = 4;
+const int NUM_INPUTS = 5;
+
+// Result of one simulation update
+const int TICK_RUNNING = 0;
+const int TICK_PLAYER_DIED = 1;
+const int TICK_PLAYER_WON = 2;
+
+// Game events, passed to gameEventSink as they happen.
+// Positions are in whole pixels.
+const int EVENT_GAME_STARTED = 0; // a: random state after setup
+const int EVENT_SCORE = 1; // a: points added, b: new score
+const int EVENT_MUSHROOM_DESTROYED = 2; // a: mushroom, b: x, c: y
+const int EVENT_SEGMENT_KILLED = 3; // a: segment, b: 1 if it was a head, c: group
+const int EVENT_SPLIT = 4; // a: hit group, b: group leading the tail, c: new head segment
+const int EVENT_HEAD_SPAWNED = 5; // a: group, b: segment, c: row
+const int EVENT_PLAYER_DIED = 6; // a: score
+const int EVENT_PLAYER_WON = 7; // a: score
+const int EVENT_POWER_UP = 8; // a: fighter, b: POWER_UP_*, c: ticks granted
+const int EVENT_CHUNK_CLEARED = 9; // Arena, instead of EVENT_PLAYER_WON; a: score, b: chunk x, c: chunk y
+const int NUM_EVENT_TYPES = 10;
+
+const int POWER_UP_RAPID_FIRE = 0;
+const int POWER_UP_SPREAD = 1;
+
+struct GameEvent {
+    unsigned int tick; // worldTick the event happened on
+    int type;
+    int a, b, c;
+};
+typedef void (*GameEventSink)(const GameEvent& event);
+
+// World hash fields, so a mismatch can name what differs
+const int HASH_PLAYER = 0;
+const int HASH_PROJECTILES = 1;
+const int HASH_CENTIPEDE = 2;
+const int HASH_GROUPS = 3;
+const int HASH_MUSHROOMS = 4;
+const int HASH_SCORE = 5;
+const int HASH_TIMERS = 6; // Tick counters and the random generator
+const int NUM_HASH_FIELDS = 7;
+
+// Autopilot (lookahead bot) settings
+const int AUTOPILOT_HORIZON_TICKS = 240; // Ticks simulated ahead for every candidate move
+const int AUTOPILOT_COMMIT_TICKS = 12; // Ticks a candidate move is held before holding still
+const int AUTOPILOT_MOVES = 9; // Every combination of -1/0/+1 on both axes
+
+// Game grid
+extern thread_local int centipedeGroup[CENTIPEDE_LENGTH]; // Tracks which group each segment belongs to
+extern thread_local bool groupMoveLeft[MAX_GROUPS]; // Movement direction for each group
+extern thread_local int groupCount; // Number of active centipede groups
+extern thread_local bool groupInPlayerArea[MAX_GROUPS]; // Tracks if group is in player area
+extern thread_local int groupHead[MAX_GROUPS]; // Segment leading each group, -1 once it is gone
+extern thread_local int segmentLag[CENTIPEDE_LENGTH]; // Place of each segment behind its head, 0 = head
+
+// Path history: every group's head writes its positions into a ring buffer and
+// each body segment reads segmentLag * segmentSpacing entries behind it
+extern thread_local int centipedePath[MAX_GROUPS][PATH_LENGTH][3];
+extern thread_local int groupPathHead[MAX_GROUPS]; // Newest entry in each group's path
+
+// Turn points: the X where each head's run along its row ends, kept until the
+// head turns or a mushroom appears or disappears in that row
+extern thread_local int groupTurnX[MAX_GROUPS];
+extern thread_local int groupTurnVersion[MAX_GROUPS]; // rowMushroomVersion the bound was built from, -1 = stale
+extern thread_local int rowMushroomVersion[GRID_ROWS]; // Bumped whenever a row's mushrooms change
+
+// Game objects
+extern thread_local int mushroomGrid[NUM_MUSHROOMS][5];
+extern thread_local int centipedeGrid[CENTIPEDE_LENGTH][3];
+extern thread_local int player[2];
+extern thread_local int partner[2]; // Second player in co-op, unused otherwise
+extern thread_local int centipedeStep; // tuning.centipedeStep when this world's game began
+extern thread_local int segmentSpacing; // Path entries between neighbours at that step
+
+// Projectile pool. Live shots are packed at the front in firing order, one
+// array per field, so a tick moves them all in one branch-free loop.
+extern thread_local int projectileCount;
+extern thread_local int projectileX[MAX_PROJECTILES];
+extern thread_local int projectileY[MAX_PROJECTILES];
+extern thread_local int projectileDrift[MAX_PROJECTILES]; // X change per tick, 0 = straight up
+extern thread_local int projectileOwner[MAX_PROJECTILES]; // FIGHTER_*
+
+// Power-ups, per fighter
+extern thread_local int rapidFireLeft[NUM_FIGHTERS]; // Ticks of rapid fire left
+extern thread_local int spreadLeft[NUM_FIGHTERS]; // Ticks of spread shot left
+extern thread_local int fireCooldown[NUM_FIGHTERS]; // Ticks until rapid fire may shoot again
+
+// Game state
+extern thread_local int score;
+extern thread_local bool moveLeft;  // Direction for centipede
+extern thread_local bool playerWon; // Tracks win condition
+extern thread_local int headSpawnTicks; // Ticks since the last head spawn
+extern thread_local int centipedeMoveTicks; // Ticks since the centipede last stepped
+extern thread_local unsigned int randomState; // Simulation RNG, part of the world so lookahead copies stay exact
+extern thread_local unsigned int worldTick; // Ticks since the game started, not part of the hash
+
+// Where this thread's game events go, nullptr = nowhere. Lookahead rollouts
+// run with it cleared, so only ticks that really happen are reported.
+extern thread_local GameEventSink gameEventSink;
+
+// Statistics, not part of the world
+extern thread_local unsigned long long collisionChecks; // Pairs tested by checkCollision
+
+// World hash, refreshed at the end of every tick
+extern thread_local unsigned int worldHash[NUM_HASH_FIELDS];
+extern thread_local bool mushroomHashDirty; // Set whenever a mushroom changes
+extern thread_local bool centipedeHashDirty; // Set whenever a segment or group changes
+
+extern thread_local int autopilotBudgetMicros; // Planning time allowed per tick
+extern thread_local int autopilotLastMove; // Index of the previous move, 4 = stand still
+extern thread_local int mushroomFieldStrategy; // FIELD_* used to lay out each new game
+extern thread_local Tuning tuning; // Change it with setTuning
+extern thread_local bool coopGame; // Two players share the world; set before initializeGame
+extern thread_local bool clearedFieldWins; // False in arena mode, where a cleared chunk ends nothing
+
+// Copy of everything the simulation reads or writes, used to clone the world
+struct WorldState {
+    int mushroomGrid[NUM_MUSHROOMS][5];
+    int centipedeGrid[CENTIPEDE_LENGTH][3];
+    int centipedeGroup[CENTIPEDE_LENGTH];
+    bool groupMoveLeft[MAX_GROUPS];
+    bool groupInPlayerArea[MAX_GROUPS];
+    int groupHead[MAX_GROUPS];
+    int segmentLag[CENTIPEDE_LENGTH];
+    int groupPathHead[MAX_GROUPS];
+    int groupTurnX[MAX_GROUPS];
+    int groupTurnVersion[MAX_GROUPS];
+    int rowMushroomVersion[GRID_ROWS];
+    int centipedePath[MAX_GROUPS][PATH_LENGTH][3];
+    int groupCount;
+    int player[2];
+    int partner[2];
+    int centipedeStep;
+    int projectileCount;
+    int projectileX[MAX_PROJECTILES];
+    int projectileY[MAX_PROJECTILES];
+    int projectileDrift[MAX_PROJECTILES];
+    int projectileOwner[MAX_PROJECTILES];
+    int rapidFireLeft[NUM_FIGHTERS];
+    int spreadLeft[NUM_FIGHTERS];
+    int fireCooldown[NUM_FIGHTERS];
+    int score;
+    bool playerWon;
+    int headSpawnTicks;
+    int centipedeMoveTicks;
+    unsigned int randomState;
+    unsigned int worldTick;
+};
+
+// Existing mushrooms bucketed by row. A centipede pass builds one first, and
+// mushrooms dropped while the groups move are appended so it stays current
+// for the rest of the pass.
+struct MushroomRows {
+    int count[GRID_ROWS];
+    int index[GRID_ROWS][NUM_MUSHROOMS];
+};
+
+// Live segments bucketed by row, for the projectile pass
+struct SegmentRows {
+    int count[GRID_ROWS];
+    int index[GRID_ROWS][CENTIPEDE_LENGTH];
+};
+
+// Function declarations
+void initializeGame();
+void initializeMushrooms();
+void initializeCentipede();
+void moveCentipede();
+void turnGroup(int group);
+void recordHeadPosition(int group);
+void updateTurnBound(int group, const MushroomRows& rows);
+void snapshotMushroomRows(MushroomRows& rows);
+void addToMushroomRows(MushroomRows& rows, int mushroom);
+void mushroomRowChanged(int y);
+void followPath();
+void checkCentipedeMushroomCollisions();
+bool checkCollision(int x1, int y1, int w1, int h1, int x2, int y2, int w2, int h2);
+bool checkPlayerCentipedeCollision(const int body[]);
+bool checkPlayerPoisonCollision(const int body[]);
+void moveProjectiles();
+void checkProjectileCollisions();
+void snapshotSegmentRows(SegmentRows& rows);
+void splitCentipede(int hitSegmentIndex);
+void spawnNewHead();
+void applyPlayerInput(int fighter, int body[], const bool input[]);
+int updateGame(const bool input[]);
+int updateGame(const bool input[], const bool partnerInput[]); // Co-op: one input per player
+void updateUnwatchedWorld(); // One centipede step for a world nobody is playing in
+int nextRandom();
+void setTuning(const Tuning& next); // Between ticks only; the centipede step applies from the next game
+inline void emitGameEvent(int type, int a, int b, int c) {
+    if (gameEventSink) {
+        GameEvent event = {worldTick, type, a, b, c};
+        gameEventSink(event);
+    }
+}
+void updateWorldHash();
+unsigned int worldHashTotal();
+void saveWorldState(WorldState& state);
+void loadWorldState(const WorldState& state);
+int findGroupHead(int group);
+void chooseAutopilotInput(bool input[]);
+
+#endif
@@ -0,0 +1,348 @@
+#include "Spectator.h"
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+
+using namespace std;
+
+// Quads each game may write, so every game owns a fixed slice of the batches
+const int SPRITE_QUADS_PER_GAME = NUM_MUSHROOMS + 1 + MAX_PROJECTILES; // Mushrooms, the player and its shots
+const int CENTIPEDE_QUADS_PER_GAME = CENTIPEDE_LENGTH;
+const int MAX_LABEL_CHARS = 24;
+const char* LABEL_CHARACTERS = "0123456789 game()";
+
+const float TILE_GAP = 4.0f; // Logical pixels between tiles
+const unsigned int MIN_LABEL_SIZE = 10;
+const unsigned int MAX_LABEL_SIZE = 24;
+
+// Atlas rows: mushroom damage states, poison damage states, then the player and the bullet
+const int ATLAS_POISON_ROW = TILE_SIZE;
+const int ATLAS_SPRITE_ROW = 2 * TILE_SIZE;
+
+struct SpectatorGame {
+    WorldState world;
+    long long gamesPlayed;
+    int score; // Copied out after each step for the labels
+};
+
+vector<SpectatorGame> spectatorGames;
+int spectatorThreads = 1;
+int spectatorBudgetMicros = 0;
+Tuning spectatorTuning = DEFAULT_TUNING; // The calling thread's at startSpectator, used on every shard
+int spectatorFieldStrategy = FIELD_SHUFFLE;
+int gridColumns = 1;
+float tileSize = SCREEN_WIDTH;
+float tileScale = 1.0f;
+float gridTop = 0.0f;
+
+sf::Texture spectatorAtlas;
+const sf::Texture* centipedeTexture = nullptr;
+const Animation* bodyWalkFrames = nullptr;
+const Animation* headWalkFrames = nullptr;
+sf::Font* labelFont = nullptr;
+unsigned int labelSize = MIN_LABEL_SIZE;
+
+vector<sf::Vertex> spriteVertices;
+vector<sf::Vertex> segmentVertices;
+vector<sf::Vertex> labelVertices;
+
+// Worker pool: threads 1..spectatorThreads-1 wait for the next generation
+vector<thread> spectatorWorkers;
+mutex poolLock;
+condition_variable startStep;
+condition_variable stepDone;
+int stepGeneration = 0;
+int pendingWorkers = 0;
+bool poolStopping = false;
+int stepTicks = 0;
+
+// The calling thread's own world and settings, set aside while it runs tiles
+struct CallerWorld {
+    WorldState world;
+    unsigned int hash[NUM_HASH_FIELDS];
+    unsigned long long collisionChecks;
+    GameEventSink sink;
+    Tuning tuning;
+    int fieldStrategy;
+    int budgetMicros;
+};
+CallerWorld callerWorld;
+
+static void writeQuad(sf::Vertex* quad, float x, float y, float size, float u, float v) {
+    quad[0] = sf::Vertex(sf::Vector2f(x, y), sf::Vector2f(u, v));
+    quad[1] = sf::Vertex(sf::Vector2f(x + size, y), sf::Vector2f(u + TILE_SIZE, v));
+    quad[2] = sf::Vertex(sf::Vector2f(x + size, y + size), sf::Vector2f(u + TILE_SIZE, v + TILE_SIZE));
+    quad[3] = sf::Vertex(sf::Vector2f(x, y + size), sf::Vector2f(u, v + TILE_SIZE));
+}
+
+static float tileLeft(int game) {
+    return (game % gridColumns) * tileSize + TILE_GAP / 2;
+}
+
+static float tileTop(int game) {
+    return gridTop + (game / gridColumns) * tileSize + TILE_GAP / 2;
+}
+
+// Writes the live world's quads into the game's slices; unused quads are
+// collapsed to a point so the batches can be drawn whole
+static void writeGameQuads(int game) {
+    float left = tileLeft(game), top = tileTop(game);
+    float size = TILE_SIZE * tileScale;
+    sf::Vertex* sprites = &spriteVertices[game * SPRITE_QUADS_PER_GAME * 4];
+    int quadCount = 0;
+    for (int i = 0; i < NUM_MUSHROOMS; ++i) {
+        if (mushroomGrid[i][EXISTS]) {
+            writeQuad(&sprites[quadCount++ * 4],
+                      left + toPixels(mushroomGrid[i][X]) * tileScale, top + toPixels(mushroomGrid[i][Y]) * tileScale, size,
+                      mushroomGrid[i][DAMAGE] * TILE_SIZE, mushroomGrid[i][IS_POISONOUS] ? ATLAS_POISON_ROW : 0);
+        }
+    }
+    writeQuad(&sprites[quadCount++ * 4], left + toPixels(player[X]) * tileScale, top + toPixels(player[Y]) * tileScale,
+              size, 0, ATLAS_SPRITE_ROW);
+    for (int p = 0; p < projectileCount; ++p) {
+        writeQuad(&sprites[quadCount++ * 4], left + toPixels(projectileX[p]) * tileScale,
+                  top + toPixels(projectileY[p]) * tileScale, size, TILE_SIZE, ATLAS_SPRITE_ROW);
+    }
+    fill(&sprites[quadCount * 4], &sprites[SPRITE_QUADS_PER_GAME * 4], sf::Vertex());
+
+    // Walk frames follow the world clock, so no per-game animation state is kept
+    sf::Vertex* segments = &segmentVertices[game * CENTIPEDE_QUADS_PER_GAME * 4];
+    float seconds = static_cast<float>(worldTick) / TICKS_PER_SECOND;
+    quadCount = 0;
+    for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
+        if (centipedeGrid[i][EXISTS]) {
+            int group = centipedeGroup[i];
+            bool isHead = (i == groupHead[group]);
+            const Animation& walk = isHead ? *headWalkFrames : *bodyWalkFrames;
+            int entry = (groupPathHead[group] - segmentLag[i] * segmentSpacing) & (PATH_LENGTH - 1);
+            bool movingLeft = isHead ? groupMoveLeft[group] : centipedePath[group][entry][PATH_MOVE_LEFT] != 0;
+            int frame = (animationFrame(walk, seconds) + segmentLag[i]) % walk.frameCount;
+            writeAnimationQuad(&segments[quadCount++ * 4], walk, frame, !movingLeft,
+                               left + toPixels(centipedeGrid[i][X]) * tileScale,
+                               top + toPixels(centipedeGrid[i][Y]) * tileScale, size);
+        }
+    }
+    fill(&segments[quadCount * 4], &segments[CENTIPEDE_QUADS_PER_GAME * 4], sf::Vertex());
+}
+
+// Tile events carry no tile number, so none reach the calling thread's sink;
+// workers have no sink either
+static void setAsideCallerWorld() {
+    saveWorldState(callerWorld.world);
+    memcpy(callerWorld.hash, worldHash, sizeof(worldHash));
+    callerWorld.collisionChecks = collisionChecks;
+    callerWorld.sink = gameEventSink;
+    callerWorld.tuning = tuning;
+    callerWorld.fieldStrategy = mushroomFieldStrategy;
+    callerWorld.budgetMicros = autopilotBudgetMicros;
+    gameEventSink = nullptr;
+    tuning = spectatorTuning;
+    mushroomFieldStrategy = spectatorFieldStrategy;
+    autopilotBudgetMicros = spectatorBudgetMicros;
+}
+
+static void restoreCallerWorld() {
+    gameEventSink = callerWorld.sink;
+    collisionChecks = callerWorld.collisionChecks;
+    tuning = callerWorld.tuning;
+    mushroomFieldStrategy = callerWorld.fieldStrategy;
+    autopilotBudgetMicros = callerWorld.budgetMicros;
+    loadWorldState(callerWorld.world);
+    memcpy(worldHash, callerWorld.hash, sizeof(worldHash));
+}
+
+static void runShard(int shard) {
+    int numGames = static_cast<int>(spectatorGames.size());
+    int begin = numGames * shard / spectatorThreads;
+    int end = numGames * (shard + 1) / spectatorThreads;
+    bool input[NUM_INPUTS];
+    for (int game = begin; game < end; ++game) {
+        SpectatorGame& spectated = spectatorGames[game];
+        loadWorldState(spectated.world);
+        for (int tick = 0; tick < stepTicks; ++tick) {
+            chooseAutopilotInput(input);
+            if (updateGame(input) != TICK_RUNNING) {
+                spectated.gamesPlayed++;
+                initializeGame(); // The next game starts straight away
+            }
+        }
+        spectated.score = score;
+        writeGameQuads(game);
+        saveWorldState(spectated.world);
+    }
+}
+
+static void workerLoop(int shard) {
+    // Settings are thread_local; without these workers play the defaults
+    autopilotBudgetMicros = spectatorBudgetMicros;
+    tuning = spectatorTuning;
+    mushroomFieldStrategy = spectatorFieldStrategy;
+    int seenGeneration = 0;
+    while (true) {
+        {
+            unique_lock<mutex> guard(poolLock);
+            startStep.wait(guard, [&] { return poolStopping || stepGeneration != seenGeneration; });
+            if (poolStopping) return;
+            seenGeneration = stepGeneration;
+        }
+
+        runShard(shard);
+
+        {
+            lock_guard<mutex> guard(poolLock);
+            if (--pendingWorkers == 0) {
+                stepDone.notify_one();
+            }
+        }
+    }
+}
+
+static bool buildAtlas(const SpectatorTextures& textures) {
+    sf::Image atlas;
+    atlas.create(4 * TILE_SIZE, 3 * TILE_SIZE, sf::Color::Transparent);
+    atlas.copy(textures.mushroom->copyToImage(), 0, 0, sf::IntRect(0, 0, 4 * TILE_SIZE, TILE_SIZE));
+    atlas.copy(textures.poisonMushroom->copyToImage(), 0, ATLAS_POISON_ROW, sf::IntRect(0, 0, 4 * TILE_SIZE, TILE_SIZE));
+    atlas.copy(textures.player->copyToImage(), 0, ATLAS_SPRITE_ROW, sf::IntRect(0, 0, TILE_SIZE, TILE_SIZE));
+    atlas.copy(textures.bullet->copyToImage(), TILE_SIZE, ATLAS_SPRITE_ROW, sf::IntRect(0, 0, TILE_SIZE, TILE_SIZE));
+    return spectatorAtlas.loadFromImage(atlas);
+}
+
+bool startSpectator(int numGames, int numThreads, unsigned int seed, int budgetMicros,
+                    const SpectatorTextures& textures, sf::Font& font) {
+    if (numGames < 1 || numGames > MAX_SPECTATOR_GAMES) return false;
+    if (!buildAtlas(textures)) return false;
+    centipedeTexture = textures.centipedeAtlas;
+    bodyWalkFrames = textures.bodyWalk;
+    headWalkFrames = textures.headWalk;
+    labelFont = &font;
+
+    // Square tiles in a grid as close to square as the count allows
+    gridColumns = static_cast<int>(ceil(sqrt(static_cast<double>(numGames))));
+    int gridRows = (numGames + gridColumns - 1) / gridColumns;
+    tileSize = static_cast<float>(SCREEN_WIDTH) / gridColumns;
+    tileScale = (tileSize - TILE_GAP) / SCREEN_WIDTH;
+    gridTop = (SCREEN_HEIGHT - gridRows * tileSize) / 2;
+    labelSize = min(max(static_cast<unsigned int>(tileSize / 16), MIN_LABEL_SIZE), MAX_LABEL_SIZE);
+    for (const char* c = LABEL_CHARACTERS; *c; ++c) {
+        font.getGlyph(*c, labelSize, false); // Loaded now, not on the frame a digit first shows
+    }
+
+    spectatorGames.resize(numGames);
+    spriteVertices.assign(numGames * SPRITE_QUADS_PER_GAME * 4, sf::Vertex());
+    segmentVertices.assign(numGames * CENTIPEDE_QUADS_PER_GAME * 4, sf::Vertex());
+    labelVertices.assign(numGames * MAX_LABEL_CHARS * 4, sf::Vertex());
+
+    spectatorThreads = min(max(numThreads, 1), numGames);
+    spectatorBudgetMicros = budgetMicros;
+    spectatorTuning = tuning;
+    spectatorFieldStrategy = mushroomFieldStrategy;
+
+    // Every game gets its own random stream and starts on the calling thread
+    setAsideCallerWorld();
+    for (int game = 0; game < numGames; ++game) {
+        randomState = seed + 0x9E3779B9u * (game + 1);
+        if (randomState == 0) randomState = 1;
+        initializeGame();
+        saveWorldState(spectatorGames[game].world);
+        spectatorGames[game].gamesPlayed = 0;
+        spectatorGames[game].score = 0;
+    }
+    restoreCallerWorld();
+
+    stepGeneration = 0;
+    pendingWorkers = 0;
+    poolStopping = false;
+    for (int shard = 1; shard < spectatorThreads; ++shard) {
+        spectatorWorkers.push_back(thread(workerLoop, shard));
+    }
+    stepSpectator(0);
+    return true;
+}
+
+void stopSpectator() {
+    {
+        lock_guard<mutex> guard(poolLock);
+        poolStopping = true;
+        startStep.notify_all();
+    }
+    for (size_t i = 0; i < spectatorWorkers.size(); ++i) {
+        spectatorWorkers[i].join();
+    }
+    spectatorWorkers.clear();
+    spectatorGames.clear();
+}
+
+void stepSpectator(int ticks) {
+    stepTicks = ticks;
+    if (spectatorThreads > 1) {
+        lock_guard<mutex> guard(poolLock);
+        pendingWorkers = spectatorThreads - 1;
+        stepGeneration++;
+        startStep.notify_all();
+    }
+
+    // The calling thread takes the first shard, with the same settings as the workers
+    setAsideCallerWorld();
+    runShard(0);
+    restoreCallerWorld();
+
+    if (spectatorThreads > 1) {
+        unique_lock<mutex> guard(poolLock);
+        stepDone.wait(guard, [&] { return pendingWorkers == 0; });
+    }
+}
+
+// Score and game number along the top of each tile; glyphs come from the
+// font's cache, which only this thread touches
+static int writeLabels() {
+    int quadCount = 0;
+    for (size_t game = 0; game < spectatorGames.size(); ++game) {
+        char text[MAX_LABEL_CHARS];
+        int length = snprintf(text, sizeof(text), "%d (game %lld)", spectatorGames[game].score,
+                              spectatorGames[game].gamesPlayed + 1);
+        if (length > MAX_LABEL_CHARS - 1) length = MAX_LABEL_CHARS - 1;
+
+        float x = tileLeft(static_cast<int>(game)) + 4.0f;
+        float baseline = tileTop(static_cast<int>(game)) + 4.0f + labelSize;
+        sf::Uint32 previous = 0;
+        for (int i = 0; i < length; ++i) {
+            sf::Uint32 c = static_cast<unsigned char>(text[i]);
+            x += labelFont->getKerning(previous, c, labelSize);
+            previous = c;
+            const sf::Glyph& glyph = labelFont->getGlyph(c, labelSize, false);
+            float left = x + glyph.bounds.left;
+            float top = baseline + glyph.bounds.top;
+            float right = left + glyph.bounds.width;
+            float bottom = top + glyph.bounds.height;
+            float u = glyph.textureRect.left, v = glyph.textureRect.top;
+            float u2 = u + glyph.textureRect.width, v2 = v + glyph.textureRect.height;
+            sf::Vertex* quad = &labelVertices[quadCount++ * 4];
+            quad[0] = sf::Vertex(sf::Vector2f(left, top), sf::Color::Green, sf::Vector2f(u, v));
+            quad[1] = sf::Vertex(sf::Vector2f(right, top), sf::Color::Green, sf::Vector2f(u2, v));
+            quad[2] = sf::Vertex(sf::Vector2f(right, bottom), sf::Color::Green, sf::Vector2f(u2, v2));
+            quad[3] = sf::Vertex(sf::Vector2f(left, bottom), sf::Color::Green, sf::Vector2f(u, v2));
+            x += glyph.advance;
+        }
+    }
+    return quadCount;
+}
+
+void drawSpectator(sf::RenderTarget& target) {
+    target.draw(spriteVertices.data(), spriteVertices.size(), sf::Quads, sf::RenderStates(&spectatorAtlas));
+    target.draw(segmentVertices.data(), segmentVertices.size(), sf::Quads, sf::RenderStates(centipedeTexture));
+    int labelQuads = writeLabels();
+    target.draw(labelVertices.data(), labelQuads * 4, sf::Quads, sf::RenderStates(&labelFont->getTexture(labelSize)));
+}
+
+long long spectatorGamesPlayed() {
+    long long total = 0;
+    for (size_t game = 0; game < spectatorGames.size(); ++game) {
+        total += spectatorGames[game].gamesPlayed;
+    }
+    return total;
+}
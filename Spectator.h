@@ -0,0 +1,38 @@
+#ifndef SPECTATOR_H
+#define SPECTATOR_H
+
+#include <SFML/Graphics.hpp>
+#include "Simulation.h"
+#include "Animation.h"
+
+// Spectator view: many independent autopilot games in one window, each in its
+// own tile of a square grid. Every game owns a WorldState; a pool of threads
+// steps them and, in the same pass, writes each game's quads into its own
+// slice of shared vertex batches. The whole view is then three draw calls
+// (sprites, centipedes, scores) whatever the number of games, all from one
+// atlas of the game's textures built at start.
+
+const int MAX_SPECTATOR_GAMES = 64;
+
+struct SpectatorTextures {
+    const sf::Texture* mushroom;
+    const sf::Texture* poisonMushroom;
+    const sf::Texture* player;
+    const sf::Texture* bullet;
+    const sf::Texture* centipedeAtlas;
+    const Animation* bodyWalk;
+    const Animation* headWalk;
+};
+
+// numThreads includes the calling thread. Each game gets its own seed and
+// plays with the tuning and field strategy in force at startSpectator. The
+// calling thread's own world is left as it was, and its event sink sees no
+// tile's events.
+bool startSpectator(int numGames, int numThreads, unsigned int seed, int budgetMicros,
+                    const SpectatorTextures& textures, sf::Font& font);
+void stopSpectator();
+void stepSpectator(int ticks); // Advances every game and rebuilds its quads; 0 only rebuilds
+void drawSpectator(sf::RenderTarget& target);
+long long spectatorGamesPlayed(); // Finished games across all tiles
+
+#endif
@@ -0,0 +1,163 @@
+#include "Telemetry.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdio>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+using namespace std;
+
+const unsigned int EVENT_RING_SIZE = 1 << 14; // Power of two
+const int WRITER_IDLE_MS = 5;
+
+const char* EVENT_NAMES[NUM_EVENT_TYPES] = {
+    "game_started", "score", "mushroom_destroyed", "segment_killed",
+    "split", "head_spawned", "player_died", "player_won", "power_up", "chunk_cleared"
+};
+// JSON names of the a, b, c fields, nullptr where unused
+const char* EVENT_FIELDS[NUM_EVENT_TYPES][3] = {
+    {"random_state", nullptr, nullptr},
+    {"points", "score", nullptr},
+    {"mushroom", "x", "y"},
+    {"segment", "head", "group"},
+    {"group", "tail_group", "head"},
+    {"group", "segment", "row"},
+    {"score", nullptr, nullptr},
+    {"score", nullptr, nullptr},
+    {"fighter", "kind", "ticks"},
+    {"score", "chunk_x", "chunk_y"}
+};
+
+// The ring: only the game thread advances ringWrite, only the writer ringRead.
+// Both sit on their own cache lines so the two threads do not share one.
+GameEvent eventRing[EVENT_RING_SIZE];
+alignas(64) atomic<unsigned int> ringWrite(0);
+alignas(64) atomic<unsigned int> ringRead(0);
+alignas(64) atomic<unsigned long long> droppedEvents(0);
+
+// Writer thread state
+thread telemetryWriter;
+atomic<bool> telemetryStopping(false);
+string telemetryPath;
+int telemetryFormat = TELEMETRY_JSONL;
+ofstream telemetryFile;
+long long telemetryBytes = 0;
+
+static void pushGameEvent(const GameEvent& event) {
+    unsigned int write = ringWrite.load(memory_order_relaxed);
+    if (write - ringRead.load(memory_order_acquire) == EVENT_RING_SIZE) {
+        droppedEvents.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+    eventRing[write & (EVENT_RING_SIZE - 1)] = event;
+    ringWrite.store(write + 1, memory_order_release);
+}
+
+static bool openTelemetryFile() {
+    if (telemetryFormat == TELEMETRY_BINARY) {
+        telemetryFile.open(telemetryPath, ios::binary);
+    } else {
+        telemetryFile.open(telemetryPath);
+    }
+    if (!telemetryFile.is_open()) return false;
+    telemetryBytes = 0;
+    if (telemetryFormat == TELEMETRY_BINARY) {
+        const char header[] = "CENTIPEDE-EVENTS 1\n";
+        telemetryFile.write(header, sizeof(header) - 1);
+        telemetryBytes += sizeof(header) - 1;
+    }
+    return true;
+}
+
+static void rotateTelemetryFile() {
+    telemetryFile.close();
+    // Shift path.N-1 -> path.N ... path -> path.1; the oldest is overwritten
+    for (int i = TELEMETRY_KEEP_FILES - 1; i >= 1; --i) {
+        string from = i == 1 ? telemetryPath : telemetryPath + "." + to_string(i - 1);
+        string to = telemetryPath + "." + to_string(i);
+        remove(to.c_str());
+        rename(from.c_str(), to.c_str());
+    }
+    if (!openTelemetryFile()) {
+        cerr << "Failed to reopen telemetry file " << telemetryPath << endl;
+    }
+}
+
+static void writeEvent(const GameEvent& event) {
+    if (telemetryFormat == TELEMETRY_BINARY) {
+        int record[5] = {static_cast<int>(event.tick), event.type, event.a, event.b, event.c};
+        telemetryFile.write(reinterpret_cast<const char*>(record), sizeof(record));
+        telemetryBytes += sizeof(record);
+        return;
+    }
+    
+    char line[160];
+    int length = snprintf(line, sizeof(line), "{\"tick\":%u,\"event\":\"%s\"", event.tick, EVENT_NAMES[event.type]);
+    const int values[3] = {event.a, event.b, event.c};
+    for (int f = 0; f < 3; ++f) {
+        if (EVENT_FIELDS[event.type][f]) {
+            length += snprintf(line + length, sizeof(line) - length, ",\"%s\":%d",
+                               EVENT_FIELDS[event.type][f], values[f]);
+        }
+    }
+    length += snprintf(line + length, sizeof(line) - length, "}\n");
+    telemetryFile.write(line, length);
+    telemetryBytes += length;
+}
+
+static void writerLoop() {
+    while (true) {
+        // Read the flag first so a final pass still sees every event pushed before it
+        bool stopping = telemetryStopping.load(memory_order_acquire);
+        unsigned int read = ringRead.load(memory_order_relaxed);
+        unsigned int write = ringWrite.load(memory_order_acquire);
+        
+        if (read == write) {
+            if (stopping) break;
+            this_thread::sleep_for(chrono::milliseconds(WRITER_IDLE_MS));
+            continue;
+        }
+        
+        while (read != write) {
+            if (telemetryFile.is_open()) {
+                writeEvent(eventRing[read & (EVENT_RING_SIZE - 1)]);
+            }
+            ++read;
+        }
+        ringRead.store(read, memory_order_release);
+        
+        if (telemetryFile.is_open()) {
+            telemetryFile.flush();
+            if (telemetryBytes >= TELEMETRY_ROTATE_BYTES) {
+                rotateTelemetryFile();
+            }
+        }
+    }
+    telemetryFile.close();
+}
+
+bool startTelemetry(const char* path, int format) {
+    telemetryPath = path;
+    telemetryFormat = format;
+    if (!openTelemetryFile()) {
+        cerr << "Failed to open telemetry file " << path << endl;
+        return false;
+    }
+    telemetryStopping.store(false);
+    telemetryWriter = thread(writerLoop);
+    gameEventSink = pushGameEvent;
+    return true;
+}
+
+void stopTelemetry() {
+    if (!telemetryWriter.joinable()) return;
+    gameEventSink = nullptr;
+    telemetryStopping.store(true, memory_order_release);
+    telemetryWriter.join();
+}
+
+unsigned long long telemetryDroppedEvents() {
+    return droppedEvents.load(memory_order_relaxed);
+}
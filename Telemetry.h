@@ -0,0 +1,27 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "Simulation.h"
+
+// Game event telemetry. The game thread pushes events into a fixed
+// single-producer/single-consumer ring and never waits: when the ring is
+// full the event is counted as dropped. A writer thread drains the ring and
+// appends the events to a file, rotating it once it grows past
+// TELEMETRY_ROTATE_BYTES (path, path.1, ... path.N with N the oldest).
+//
+// JSONL: one object per line, {"tick":..,"event":"score","points":..,..}
+// Binary: a "CENTIPEDE-EVENTS 1\n" line, then raw GameEvent records
+// (five native-endian 32-bit ints: tick, type, a, b, c).
+
+const int TELEMETRY_JSONL = 0;
+const int TELEMETRY_BINARY = 1;
+
+const long long TELEMETRY_ROTATE_BYTES = 16 * 1024 * 1024;
+const int TELEMETRY_KEEP_FILES = 4; // Current file plus rotated ones
+
+// Installs the event sink on the calling thread, which becomes the producer
+bool startTelemetry(const char* path, int format);
+void stopTelemetry(); // Writes out everything still queued
+unsigned long long telemetryDroppedEvents();
+
+#endif
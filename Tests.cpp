@@ -0,0 +1,499 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <filesystem>
+#include <unistd.h>
+#include <cstring>
+#include <cstdlib>
+#include "Simulation.h"
+#include "MushroomField.h"
+#include "Tuning.h"
+#include "Replay.h"
+#include "Netplay.h"
+#include "VectorEnv.h"
+
+using namespace std;
+
+// Regression checks on the core library, run by ctest. Each check is named
+// on the command line; with no names every check runs. The replay corpus is
+// the main suite, the rest cover what the corpus cannot show by itself.
+
+const int TEST_TICKS = 2000;
+
+static const char* replayPath = "replays";
+
+static bool fail(const char* test, const char* reason) {
+    cerr << test << ": " << reason << endl;
+    return false;
+}
+
+// Scripted inputs: a mask held for a few ticks at a time, the same for a seed
+static void scriptedInput(unsigned int& inputRandom, long long tick, bool input[NUM_INPUTS]) {
+    if (tick % 8 != 0) return;
+    inputRandom ^= inputRandom << 13;
+    inputRandom ^= inputRandom >> 17;
+    inputRandom ^= inputRandom << 5;
+    for (int i = 0; i < NUM_INPUTS; ++i) {
+        input[i] = (inputRandom >> i) & 1;
+    }
+}
+
+// Plays one game and writes the world hash after every tick
+static void playScripted(unsigned int seed, vector<unsigned int>& hashes) {
+    randomState = seed;
+    initializeGame();
+    unsigned int inputRandom = seed;
+    bool input[NUM_INPUTS] = {false};
+    hashes.clear();
+    for (long long tick = 0; tick < TEST_TICKS; ++tick) {
+        scriptedInput(inputRandom, tick, input);
+        int outcome = updateGame(input);
+        hashes.push_back(worldHashTotal());
+        if (outcome != TICK_RUNNING) break;
+    }
+}
+
+static bool testReplays() {
+    return verifyReplays(replayPath);
+}
+
+static bool testHashDeterminism() {
+    vector<unsigned int> first, second, other;
+    playScripted(1, first);
+    playScripted(1, second);
+    if (first != second) return fail("hash-determinism", "two games from the same seed diverged");
+    playScripted(2, other);
+    if (first == other) return fail("hash-determinism", "games from different seeds hashed the same");
+    return true;
+}
+
+// A restored world must hash the same and play on exactly as the original did
+static bool testHashSaveLoad() {
+    randomState = 1;
+    initializeGame();
+    unsigned int inputRandom = 1;
+    bool input[NUM_INPUTS] = {false};
+    for (long long tick = 0; tick < TEST_TICKS / 2; ++tick) {
+        scriptedInput(inputRandom, tick, input);
+        if (updateGame(input) != TICK_RUNNING) return fail("hash-save-load", "game ended before the snapshot");
+    }
+
+    static WorldState saved; // Too large for the stack
+    saveWorldState(saved);
+    unsigned int savedHash = worldHashTotal();
+    unsigned int savedInputRandom = inputRandom;
+    bool savedInput[NUM_INPUTS];
+    memcpy(savedInput, input, sizeof(input));
+
+    vector<unsigned int> original;
+    for (long long tick = TEST_TICKS / 2; tick < TEST_TICKS; ++tick) {
+        scriptedInput(inputRandom, tick, input);
+        int outcome = updateGame(input);
+        original.push_back(worldHashTotal());
+        if (outcome != TICK_RUNNING) break;
+    }
+
+    // Loading only marks the world for rehashing
+    loadWorldState(saved);
+    updateWorldHash();
+    if (worldHashTotal() != savedHash) return fail("hash-save-load", "loaded world hashes differently");
+
+    inputRandom = savedInputRandom;
+    memcpy(input, savedInput, sizeof(input));
+    vector<unsigned int> restored;
+    for (long long tick = TEST_TICKS / 2; tick < TEST_TICKS; ++tick) {
+        scriptedInput(inputRandom, tick, input);
+        int outcome = updateGame(input);
+        restored.push_back(worldHashTotal());
+        if (outcome != TICK_RUNNING) break;
+    }
+    if (original != restored) return fail("hash-save-load", "loaded world played on differently");
+    return true;
+}
+
+// Changing one part of the world must change its own hash field and no other
+static bool checkHashField(WorldState& base, int field, const char* name) {
+    unsigned int before[NUM_HASH_FIELDS];
+    loadWorldState(base);
+    updateWorldHash();
+    memcpy(before, worldHash, sizeof(before));
+
+    switch (field) {
+        case HASH_PLAYER: player[0] += 1; break;
+        case HASH_PROJECTILES: projectileY[0] -= 1; break;
+        case HASH_CENTIPEDE: centipedeGrid[0][0] += 1; centipedeHashDirty = true; break;
+        case HASH_GROUPS: groupMoveLeft[0] = !groupMoveLeft[0]; centipedeHashDirty = true; break;
+        case HASH_MUSHROOMS: mushroomGrid[0][2] += 1; mushroomHashDirty = true; break;
+        case HASH_SCORE: score += 1; break;
+        case HASH_TIMERS: headSpawnTicks += 1; break;
+    }
+    updateWorldHash();
+
+    for (int i = 0; i < NUM_HASH_FIELDS; ++i) {
+        if ((worldHash[i] != before[i]) != (i == field)) {
+            cerr << "hash-fields: changing the " << name << " changed field " << i
+                 << " (expected only field " << field << ")" << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool testHashFields() {
+    randomState = 1;
+    initializeGame();
+    bool input[NUM_INPUTS] = {false};
+    input[INPUT_FIRE] = true;
+    updateGame(input); // So there is a projectile to change
+    if (projectileCount == 0) return fail("hash-fields", "no projectile after firing");
+
+    static WorldState base;
+    saveWorldState(base);
+    bool ok = checkHashField(base, HASH_PLAYER, "player");
+    ok = checkHashField(base, HASH_PROJECTILES, "projectile") && ok;
+    ok = checkHashField(base, HASH_CENTIPEDE, "centipede") && ok;
+    ok = checkHashField(base, HASH_GROUPS, "group direction") && ok;
+    ok = checkHashField(base, HASH_MUSHROOMS, "mushroom") && ok;
+    ok = checkHashField(base, HASH_SCORE, "score") && ok;
+    ok = checkHashField(base, HASH_TIMERS, "head spawn timer") && ok;
+    return ok;
+}
+
+static int sinkEvents = 0;
+
+static void countEvent(const GameEvent&) {
+    sinkEvents++;
+}
+
+// Stepping a VectorEnv must leave the calling thread's world and sink alone
+static bool testVectorEnvCallerWorld() {
+    randomState = 7;
+    initializeGame();
+    gameEventSink = countEvent;
+    sinkEvents = 0;
+    unsigned int callerHash = worldHashTotal();
+    unsigned int callerRandom = randomState;
+
+    const int envs = 4;
+    VectorEnv* env = createVectorEnv(envs, 2, 1);
+    vector<unsigned char> observations(envs * OBSERVATION_SIZE);
+    vector<unsigned char> actions(envs, 1 << INPUT_FIRE), dones(envs);
+    vector<int> scores(envs);
+    resetVectorEnv(env, observations.data());
+    for (int step = 0; step < TEST_TICKS / 4; ++step) {
+        stepVectorEnv(env, actions.data(), observations.data(), scores.data(), dones.data());
+    }
+    destroyVectorEnv(env);
+
+    bool ok = true;
+    if (worldHashTotal() != callerHash || randomState != callerRandom) {
+        ok = fail("vector-env", "stepping changed the caller's world");
+    }
+    if (gameEventSink != countEvent) ok = fail("vector-env", "stepping replaced the caller's event sink");
+    if (sinkEvents != 0) ok = fail("vector-env", "the caller's sink saw the vector worlds' events");
+    gameEventSink = nullptr;
+    return ok;
+}
+
+// Checks one generated field: count, bounds, no tile twice, and the
+// strategy's own promise (spacing, or each row's share of the weights)
+static bool checkField(const FieldSpec& spec, const int tiles[], int placed) {
+    const char* strategy = spec.strategy == FIELD_SPACED ? "spaced" : spec.strategy == FIELD_ROW_PROFILE ? "rows" : "shuffle";
+    int tileCount = spec.columns * spec.rows;
+    int wanted = min(max(spec.count, 0), tileCount);
+    if (spec.strategy == FIELD_SPACED ? placed > wanted || (wanted > 0 && placed == 0) : placed != wanted) {
+        cerr << "field-strategies: " << strategy << " placed " << placed << " of " << spec.count
+             << " on " << spec.columns << "x" << spec.rows << endl;
+        return false;
+    }
+    vector<bool> used(tileCount, false);
+    vector<int> rowCount(spec.rows, 0);
+    for (int i = 0; i < placed; ++i) {
+        if (tiles[i] < 0 || tiles[i] >= tileCount || used[tiles[i]]) {
+            cerr << "field-strategies: " << strategy << " wrote tile " << tiles[i] << " out of range or twice" << endl;
+            return false;
+        }
+        used[tiles[i]] = true;
+        rowCount[tiles[i] / spec.columns]++;
+    }
+
+    if (spec.strategy == FIELD_SPACED) {
+        for (int i = 0; i < placed; ++i) {
+            for (int j = i + 1; j < placed; ++j) {
+                int dx = abs(tiles[i] % spec.columns - tiles[j] % spec.columns);
+                int dy = abs(tiles[i] / spec.columns - tiles[j] / spec.columns);
+                if (max(dx, dy) < spec.spacing) return fail("field-strategies", "spaced placed two mushrooms too close");
+            }
+        }
+    }
+    if (spec.strategy == FIELD_ROW_PROFILE) {
+        // Every row gets the floor of its share, plus at most one of the
+        // remainder until full rows push it on to the others
+        bool anyFull = false;
+        for (int row = 0; row < spec.rows; ++row) {
+            if (rowCount[row] == spec.columns) anyFull = true;
+        }
+        float totalWeight = 0.0f;
+        for (int row = 0; row < spec.rows; ++row) {
+            totalWeight += spec.rowWeights ? spec.rowWeights[row] : static_cast<float>(spec.rows - row);
+        }
+        for (int row = 0; row < spec.rows; ++row) {
+            float weight = spec.rowWeights ? spec.rowWeights[row] : static_cast<float>(spec.rows - row);
+            int share = min(static_cast<int>(wanted * weight / totalWeight), spec.columns);
+            if (rowCount[row] < share || (!anyFull && rowCount[row] > share + 1)) {
+                cerr << "field-strategies: rows put " << rowCount[row] << " mushrooms in row " << row
+                     << " for a share of " << share << endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool testFieldStrategies() {
+    static const float TOP_HEAVY[4] = {4.0f, 0.0f, 1.0f, 3.0f};
+    const FieldSpec specs[] = {
+        {0, GRID_COLS, GRID_ROWS - MAX_PLAYER_ROWS, 30, MUSHROOM_SPACING, nullptr}, // The game's field
+        {0, GRID_COLS, GRID_ROWS - MAX_PLAYER_ROWS, NUM_MUSHROOMS, MUSHROOM_SPACING, nullptr},
+        {0, 8, 4, 32, 1, TOP_HEAVY}, // Every tile
+        {0, 8, 4, 50, 3, TOP_HEAVY}, // More than fit
+        {0, 200, 150, 40, 4, nullptr}, // Sparse draws from a large field
+        {0, 8, 4, 1, 2, TOP_HEAVY},
+        {0, 8, 4, 0, 2, nullptr},
+    };
+    const int numSpecs = sizeof(specs) / sizeof(specs[0]);
+    vector<int> tiles(200 * 150), again(200 * 150);
+    bool ok = true;
+
+    // Small fields after large ones too, so stale scratch entries would show
+    for (int round = 0; round < 2; ++round) {
+        for (int strategy = 0; strategy < NUM_FIELD_STRATEGIES; ++strategy) {
+            for (int s = 0; s < numSpecs; ++s) {
+                FieldSpec spec = specs[s];
+                spec.strategy = strategy;
+                unsigned int random = 11 + round, randomAgain = 11 + round;
+                int placed = generateMushroomField(spec, random, tiles.data());
+                if (!checkField(spec, tiles.data(), placed)) ok = false;
+
+                int placedAgain = generateMushroomField(spec, randomAgain, again.data());
+                if (placedAgain != placed || random != randomAgain ||
+                    !equal(tiles.begin(), tiles.begin() + placed, again.begin())) {
+                    ok = fail("field-strategies", "the same seed gave a different field");
+                }
+            }
+        }
+    }
+
+    for (int strategy = 0; strategy < NUM_FIELD_STRATEGIES; ++strategy) {
+        FieldSpec spec = specs[0];
+        spec.strategy = strategy;
+        unsigned int first = 1, second = 2;
+        generateMushroomField(spec, first, tiles.data());
+        generateMushroomField(spec, second, again.data());
+        if (equal(tiles.begin(), tiles.begin() + spec.count, again.begin())) {
+            ok = fail("field-strategies", "different seeds gave the same field");
+        }
+    }
+
+    if (fieldStrategyFromName("shuffle") != FIELD_SHUFFLE || fieldStrategyFromName("spaced") != FIELD_SPACED ||
+        fieldStrategyFromName("rows") != FIELD_ROW_PROFILE || fieldStrategyFromName("grid") != -1) {
+        ok = fail("field-strategies", "strategy names do not map to their strategies");
+    }
+    return ok;
+}
+
+// Writes text to a scratch file and parses it the way the watcher does
+static bool parseTuningText(const char* text, Tuning& result) {
+    string path = (filesystem::temp_directory_path() / ("centipede-tuning-" + to_string(getpid()) + ".cfg")).string();
+    {
+        ofstream file(path, ios::trunc);
+        file << text;
+    }
+    bool parsed = parseTuningFile(path.c_str(), result);
+    remove(path.c_str());
+    return parsed;
+}
+
+static bool testTuningParse() {
+    bool ok = true;
+    Tuning parsed = DEFAULT_TUNING;
+    if (!parseTuningText("# comment\n\nplayer_speed = 600\n  mushrooms=12   # trailing comment\r\n"
+                         "centipede_step = 8\nrapid_fire_ticks = 0\n", parsed)) {
+        ok = fail("tuning-parse", "a valid file was rejected");
+    } else if (parsed.playerStep != 600 * FIXED_ONE / TICKS_PER_SECOND || parsed.mushroomCount != 12 ||
+               parsed.centipedeStep != 8 * FIXED_ONE || parsed.rapidFireTicks != 0 ||
+               parsed.headSpawnTicks != DEFAULT_TUNING.headSpawnTicks ||
+               parsed.centipedeMoveTicks != DEFAULT_TUNING.centipedeMoveTicks) {
+        ok = fail("tuning-parse", "a valid file gave the wrong tuning");
+    }
+
+    // Both ends of a range are allowed
+    string edges = "mushrooms = 0\ncentipede_step = " + to_string(TILE_SIZE) + "\nbullet_speed = 24000\n";
+    Tuning edgeTuning = DEFAULT_TUNING;
+    if (!parseTuningText(edges.c_str(), edgeTuning) || edgeTuning.mushroomCount != 0 ||
+        edgeTuning.centipedeStep != TILE_SIZE * FIXED_ONE) {
+        ok = fail("tuning-parse", "values at the ends of their ranges were rejected");
+    }
+    Tuning empty = parsed;
+    if (!parseTuningText("", empty) || empty.mushroomCount != DEFAULT_TUNING.mushroomCount ||
+        empty.centipedeStep != DEFAULT_TUNING.centipedeStep) {
+        ok = fail("tuning-parse", "an empty file did not give the defaults");
+    }
+
+    // Any bad line rejects the whole file and leaves the result alone
+    string tooMany = "mushrooms = " + to_string(NUM_MUSHROOMS + 1) + "\n";
+    const char* rejected[] = {
+        tooMany.c_str(),
+        "centipede_step = 2\n", // Below the minimum
+        "player_speed = -600\n",
+        "bullet_speed = 99999999999999999999\n",
+        "gravity = 3\n", // Unknown name
+        "Player_Speed = 600\n",
+        "player_speed 600\n", // No '='
+        "player_speed =\n",
+        "= 600\n",
+        "player_speed = 6x0\n",
+        "player_speed = 600.5\n",
+        "mushrooms = 12\nplayer_speed = fast\n", // A good line does not save a bad file
+    };
+    const int numRejected = sizeof(rejected) / sizeof(rejected[0]);
+    for (int i = 0; i < numRejected; ++i) {
+        Tuning kept = DEFAULT_TUNING;
+        kept.mushroomCount = 7;
+        if (parseTuningText(rejected[i], kept)) {
+            cerr << "tuning-parse: accepted " << rejected[i];
+            ok = false;
+        } else if (kept.mushroomCount != 7 || kept.playerStep != DEFAULT_TUNING.playerStep) {
+            cerr << "tuning-parse: rejecting " << rejected[i] << "still changed the tuning" << endl;
+            ok = false;
+        }
+    }
+
+    Tuning missing = DEFAULT_TUNING;
+    if (parseTuningFile("/nonexistent/tuning.cfg", missing)) ok = fail("tuning-parse", "a missing file was accepted");
+    return ok;
+}
+
+struct VectorRun {
+    vector<unsigned char> observations, dones;
+    vector<int> scores;
+};
+
+static void runVectorEnv(int threads, VectorRun& run) {
+    const int envs = 8;
+    VectorEnv* env = createVectorEnv(envs, threads, 3);
+    vector<unsigned char> observations(envs * OBSERVATION_SIZE);
+    vector<unsigned char> actions(envs), dones(envs);
+    vector<int> scores(envs);
+    resetVectorEnv(env, observations.data());
+    run.observations = observations;
+    run.dones.clear();
+    run.scores.clear();
+    unsigned int inputRandom = 3;
+    bool input[NUM_INPUTS] = {false};
+    for (int step = 0; step < TEST_TICKS / 4; ++step) {
+        scriptedInput(inputRandom, step, input);
+        for (int i = 0; i < envs; ++i) {
+            actions[i] = 0;
+            for (int k = 0; k < NUM_INPUTS; ++k) {
+                if (input[(k + i) % NUM_INPUTS]) actions[i] |= 1 << k;
+            }
+        }
+        stepVectorEnv(env, actions.data(), observations.data(), scores.data(), dones.data());
+        run.observations.insert(run.observations.end(), observations.begin(), observations.end());
+        run.dones.insert(run.dones.end(), dones.begin(), dones.end());
+        run.scores.insert(run.scores.end(), scores.begin(), scores.end());
+    }
+    destroyVectorEnv(env);
+}
+
+// Worker threads must play with the creating thread's tuning and field, not
+// their own defaults, so the thread count cannot change the results
+static bool testVectorEnvThreads() {
+    Tuning custom = DEFAULT_TUNING;
+    custom.mushroomCount = 10;
+    custom.centipedeMoveTicks = 2;
+    custom.bulletStep = 2 * DEFAULT_TUNING.bulletStep;
+    setTuning(custom);
+    mushroomFieldStrategy = FIELD_ROW_PROFILE;
+
+    VectorRun single, pooled;
+    runVectorEnv(1, single);
+    runVectorEnv(4, pooled);
+    setTuning(DEFAULT_TUNING);
+    mushroomFieldStrategy = FIELD_SHUFFLE;
+
+    bool ok = true;
+    for (int i = 0; i < 8; ++i) {
+        const unsigned char* observation = &pooled.observations[i * OBSERVATION_SIZE];
+        if (count(observation, observation + OBSERVATION_SIZE, TILE_MUSHROOM) != custom.mushroomCount) {
+            ok = fail("vector-env-threads", "a world ignored the tuned mushroom count");
+            break;
+        }
+    }
+    if (single.observations != pooled.observations) ok = fail("vector-env-threads", "observations depend on the thread count");
+    if (single.scores != pooled.scores) ok = fail("vector-env-threads", "scores depend on the thread count");
+    if (single.dones != pooled.dones) ok = fail("vector-env-threads", "game ends depend on the thread count");
+    return ok;
+}
+
+static bool testNetplayLoopback() {
+    return runNetplayLoopbackTest(2 * TICKS_PER_SECOND, 1, 30, 10);
+}
+
+struct Test {
+    const char* name;
+    bool (*run)();
+};
+
+static const Test TESTS[] = {
+    {"replays", testReplays},
+    {"hash-determinism", testHashDeterminism},
+    {"hash-save-load", testHashSaveLoad},
+    {"hash-fields", testHashFields},
+    {"field-strategies", testFieldStrategies},
+    {"tuning-parse", testTuningParse},
+    {"vector-env", testVectorEnvCallerWorld},
+    {"vector-env-threads", testVectorEnvThreads},
+    {"netplay-loopback", testNetplayLoopback},
+};
+const int NUM_TESTS = sizeof(TESTS) / sizeof(TESTS[0]);
+
+static bool runTest(const Test& test) {
+    bool ok = test.run();
+    cout << (ok ? "PASS " : "FAIL ") << test.name << endl;
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    vector<const Test*> selected;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--replays") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+            continue;
+        }
+        const Test* found = nullptr;
+        for (int t = 0; t < NUM_TESTS; ++t) {
+            if (strcmp(argv[i], TESTS[t].name) == 0) found = &TESTS[t];
+        }
+        if (!found) {
+            cerr << "Usage: " << argv[0] << " [--replays PATH] [TEST...]" << endl << "Tests:";
+            for (int t = 0; t < NUM_TESTS; ++t) cerr << " " << TESTS[t].name;
+            cerr << endl;
+            return -1;
+        }
+        selected.push_back(found);
+    }
+    if (selected.empty()) {
+        for (int t = 0; t < NUM_TESTS; ++t) selected.push_back(&TESTS[t]);
+    }
+
+    int failed = 0;
+    for (size_t i = 0; i < selected.size(); ++i) {
+        if (!runTest(*selected[i])) failed++;
+    }
+    if (failed) cout << failed << " of " << selected.size() << " tests failed" << endl;
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,191 @@
+#include "Tuning.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdlib>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <filesystem>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+using namespace std;
+
+const int KNOB_PLAYER_SPEED = 0;
+const int KNOB_BULLET_SPEED = 1;
+const int KNOB_CENTIPEDE_STEP = 2;
+const int KNOB_CENTIPEDE_MOVE_TICKS = 3;
+const int KNOB_HEAD_SPAWN_TICKS = 4;
+const int KNOB_MUSHROOMS = 5;
+const int KNOB_RAPID_FIRE_TICKS = 6;
+const int KNOB_SPREAD_TICKS = 7;
+const int KNOB_RAPID_FIRE_INTERVAL = 8;
+const int NUM_KNOBS = 9;
+
+const char* KNOB_NAMES[NUM_KNOBS] = {
+    "player_speed", "bullet_speed", "centipede_step", "centipede_move_ticks", "head_spawn_ticks", "mushrooms",
+    "rapid_fire_ticks", "spread_ticks", "rapid_fire_interval"
+};
+// The centipede step must leave the path long enough for a whole tail
+const int KNOB_MINIMUM[NUM_KNOBS] = {60, 120, 3, 1, 1, 0, 0, 0, 1};
+const int KNOB_MAXIMUM[NUM_KNOBS] = {12000, 24000, TILE_SIZE, TICKS_PER_SECOND, 60 * TICKS_PER_SECOND, NUM_MUSHROOMS,
+                                     60 * TICKS_PER_SECOND, 60 * TICKS_PER_SECOND, TICKS_PER_SECOND};
+static_assert(PATH_LENGTH > (CENTIPEDE_LENGTH - 1) * ((TILE_SIZE + 2) / 3), "path too short for the slowest step");
+
+const int WATCH_POLL_MS = 200; // How often the watcher checks for stopTuningWatch
+
+thread tuningWatcher;
+atomic<bool> tuningStopping(false);
+string tuningPath;
+int tuningNotify = -1;
+
+// Handed from the watcher to the game thread
+mutex pendingLock;
+Tuning pendingTuning;
+atomic<bool> tuningPending(false);
+
+static string trim(const string& text) {
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == string::npos) return "";
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+bool parseTuningFile(const char* path, Tuning& result) {
+    ifstream file(path);
+    if (!file.is_open()) {
+        cerr << "Failed to open tuning file " << path << endl;
+        return false;
+    }
+
+    int knobs[NUM_KNOBS] = {
+        DEFAULT_TUNING.playerStep * TICKS_PER_SECOND / FIXED_ONE,
+        (DEFAULT_TUNING.bulletStep * TICKS_PER_SECOND + FIXED_ONE - 1) / FIXED_ONE,
+        DEFAULT_TUNING.centipedeStep / FIXED_ONE,
+        DEFAULT_TUNING.centipedeMoveTicks,
+        DEFAULT_TUNING.headSpawnTicks,
+        DEFAULT_TUNING.mushroomCount,
+        DEFAULT_TUNING.rapidFireTicks,
+        DEFAULT_TUNING.spreadTicks,
+        DEFAULT_TUNING.rapidFireInterval
+    };
+    bool valid = true;
+    string line;
+    int lineNumber = 0;
+    while (getline(file, line)) {
+        ++lineNumber;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+
+        size_t equals = line.find('=');
+        string name = trim(line.substr(0, equals));
+        int knob = 0;
+        while (knob < NUM_KNOBS && name != KNOB_NAMES[knob]) ++knob;
+        if (equals == string::npos || knob == NUM_KNOBS) {
+            cerr << path << ":" << lineNumber << ": expected one of the tuning names = value" << endl;
+            valid = false;
+            continue;
+        }
+
+        string value = trim(line.substr(equals + 1));
+        char* end = nullptr;
+        long number = strtol(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || number < KNOB_MINIMUM[knob] || number > KNOB_MAXIMUM[knob]) {
+            cerr << path << ":" << lineNumber << ": " << name << " must be a whole number from "
+                 << KNOB_MINIMUM[knob] << " to " << KNOB_MAXIMUM[knob] << endl;
+            valid = false;
+            continue;
+        }
+        knobs[knob] = static_cast<int>(number);
+    }
+    if (!valid) return false;
+
+    result.playerStep = knobs[KNOB_PLAYER_SPEED] * FIXED_ONE / TICKS_PER_SECOND;
+    result.bulletStep = knobs[KNOB_BULLET_SPEED] * FIXED_ONE / TICKS_PER_SECOND;
+    result.centipedeStep = knobs[KNOB_CENTIPEDE_STEP] * FIXED_ONE;
+    result.centipedeMoveTicks = knobs[KNOB_CENTIPEDE_MOVE_TICKS];
+    result.headSpawnTicks = knobs[KNOB_HEAD_SPAWN_TICKS];
+    result.mushroomCount = knobs[KNOB_MUSHROOMS];
+    result.rapidFireTicks = knobs[KNOB_RAPID_FIRE_TICKS];
+    result.spreadTicks = knobs[KNOB_SPREAD_TICKS];
+    result.rapidFireInterval = knobs[KNOB_RAPID_FIRE_INTERVAL];
+    return true;
+}
+
+static void watchTuningFile() {
+    // Editors often save by writing a new file and renaming it over the old
+    // one, so the directory is watched rather than the file
+    string fileName = filesystem::path(tuningPath).filename().string();
+    alignas(inotify_event) char events[4096];
+    pollfd watched = {tuningNotify, POLLIN, 0};
+    while (!tuningStopping.load()) {
+        if (poll(&watched, 1, WATCH_POLL_MS) <= 0) continue;
+
+        bool changed = false;
+        ssize_t length;
+        while ((length = read(tuningNotify, events, sizeof(events))) > 0) {
+            for (char* next = events; next < events + length;) {
+                inotify_event* event = reinterpret_cast<inotify_event*>(next);
+                if (event->len > 0 && fileName == event->name) changed = true;
+                next += sizeof(inotify_event) + event->len;
+            }
+        }
+        if (!changed) continue;
+
+        Tuning next;
+        if (!parseTuningFile(tuningPath.c_str(), next)) {
+            cerr << "Keeping the current tuning" << endl;
+            continue;
+        }
+        {
+            lock_guard<mutex> guard(pendingLock);
+            pendingTuning = next;
+        }
+        tuningPending.store(true, memory_order_release);
+        cout << "Reloaded tuning from " << tuningPath << endl;
+    }
+}
+
+bool startTuningWatch(const char* path) {
+    Tuning initial;
+    if (!parseTuningFile(path, initial)) {
+        return false;
+    }
+    setTuning(initial);
+
+    tuningPath = path;
+    string directory = filesystem::path(tuningPath).parent_path().string();
+    if (directory.empty()) directory = ".";
+    tuningNotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (tuningNotify == -1 ||
+        inotify_add_watch(tuningNotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) == -1) {
+        cerr << "Failed to watch " << directory << " for tuning changes" << endl;
+        if (tuningNotify != -1) close(tuningNotify);
+        tuningNotify = -1;
+        return false;
+    }
+    tuningStopping.store(false);
+    tuningWatcher = thread(watchTuningFile);
+    return true;
+}
+
+void applyTuningUpdate() {
+    if (!tuningPending.load(memory_order_acquire)) return;
+    Tuning next;
+    {
+        lock_guard<mutex> guard(pendingLock);
+        next = pendingTuning;
+        tuningPending.store(false, memory_order_relaxed);
+    }
+    setTuning(next);
+}
+
+void stopTuningWatch() {
+    if (!tuningWatcher.joinable()) return;
+    tuningStopping.store(true);
+    tuningWatcher.join();
+    close(tuningNotify);
+    tuningNotify = -1;
+}
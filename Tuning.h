@@ -0,0 +1,27 @@
+#ifndef TUNING_H
+#define TUNING_H
+
+#include "Simulation.h"
+
+// Gameplay tuning read from a text file of "name = value" lines, where '#'
+// starts a comment and missing names keep their defaults:
+//   player_speed          px/s
+//   bullet_speed          px/s
+//   centipede_step        px per centipede step, from the next game
+//   centipede_move_ticks  ticks between centipede steps
+//   head_spawn_ticks      ticks between head spawns in the player area
+//   mushrooms             mushrooms in each new field
+//   rapid_fire_ticks      rapid fire granted by killing a head, 0 = off
+//   spread_ticks          spread shot granted by destroying a poison mushroom, 0 = off
+//   rapid_fire_interval   ticks between rapid-fire shots
+// A watcher thread follows the file with inotify and parses every saved
+// version into a complete Tuning. The game thread swaps it in between ticks
+// with applyTuningUpdate, so no tick sees half an update. A version with any
+// error is reported and ignored, and the tuning in use stays.
+
+bool parseTuningFile(const char* path, Tuning& result); // Reports errors on stderr
+bool startTuningWatch(const char* path); // Applies the file once, then watches it
+void applyTuningUpdate(); // Game thread, between ticks
+void stopTuningWatch();
+
+#endif
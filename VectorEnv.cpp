@@ -0,0 +1,231 @@
+#include "VectorEnv.h"
+#include <cstring>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+const int JOB_RESET = 0;
+const int JOB_STEP = 1;
+
+struct VectorEnv {
+    int numEnvs;
+    int numThreads;
+    vector<WorldState> worlds;
+    WorldState callerWorld; // The calling thread's own world, kept while it runs shard 0
+    Tuning tuning; // The creating thread's tuning and field strategy, used on every shard
+    int fieldStrategy;
+    
+    // Arguments of the job currently being run
+    int job;
+    const unsigned char* actions;
+    unsigned char* observations;
+    int* scores;
+    unsigned char* dones;
+    
+    // Worker pool: threads 1..numThreads-1 wait for the next generation
+    vector<thread> workers;
+    mutex lock;
+    condition_variable startJob;
+    condition_variable jobDone;
+    int generation;
+    int pendingWorkers;
+    bool stopping;
+};
+
+static void writeObservation(unsigned char* observation) {
+    memset(observation, TILE_EMPTY, OBSERVATION_SIZE);
+    
+    for (int i = 0; i < NUM_MUSHROOMS; ++i) {
+        if (mushroomGrid[i][EXISTS]) {
+            // Poisonous mushrooms are dropped where a segment was, which need not be on the grid
+            int centerX = mushroomGrid[i][X] + TILE_FIXED / 2;
+            int row = mushroomGrid[i][Y] / TILE_FIXED;
+            if (centerX >= 0 && centerX < SCREEN_WIDTH_FIXED && row >= 0 && row < GRID_ROWS) {
+                observation[row * GRID_COLS + centerX / TILE_FIXED] =
+                    mushroomGrid[i][IS_POISONOUS] ? TILE_POISON_MUSHROOM : TILE_MUSHROOM;
+            }
+        }
+    }
+    
+    for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
+        if (centipedeGrid[i][EXISTS]) {
+            // Segments off the side of the screen are not visible
+            int centerX = centipedeGrid[i][X] + TILE_FIXED / 2;
+            int row = centipedeGrid[i][Y] / TILE_FIXED;
+            if (centerX >= 0 && centerX < SCREEN_WIDTH_FIXED && row >= 0 && row < GRID_ROWS) {
+                observation[row * GRID_COLS + centerX / TILE_FIXED] = TILE_SEGMENT;
+            }
+        }
+    }
+    for (int group = 0; group < groupCount; ++group) {
+        int headIndex = findGroupHead(group);
+        if (headIndex != -1) {
+            int centerX = centipedeGrid[headIndex][X] + TILE_FIXED / 2;
+            int row = centipedeGrid[headIndex][Y] / TILE_FIXED;
+            if (centerX >= 0 && centerX < SCREEN_WIDTH_FIXED && row >= 0 && row < GRID_ROWS) {
+                observation[row * GRID_COLS + centerX / TILE_FIXED] = TILE_HEAD;
+            }
+        }
+    }
+    
+    for (int p = 0; p < projectileCount; ++p) {
+        int centerX = projectileX[p] + TILE_FIXED / 2;
+        int centerY = projectileY[p] + TILE_FIXED / 2;
+        if (centerX >= 0 && centerX < SCREEN_WIDTH_FIXED && centerY >= 0) {
+            observation[(centerY / TILE_FIXED) * GRID_COLS + centerX / TILE_FIXED] = TILE_BULLET;
+        }
+    }
+    
+    int playerCol = (player[X] + TILE_FIXED / 2) / TILE_FIXED;
+    int playerRow = (player[Y] + TILE_FIXED / 2) / TILE_FIXED;
+    if (playerCol >= GRID_COLS) playerCol = GRID_COLS - 1;
+    if (playerRow >= GRID_ROWS) playerRow = GRID_ROWS - 1;
+    observation[playerRow * GRID_COLS + playerCol] = TILE_PLAYER;
+}
+
+static void runShard(VectorEnv* env, int shard) {
+    int begin = static_cast<int>(static_cast<long long>(env->numEnvs) * shard / env->numThreads);
+    int end = static_cast<int>(static_cast<long long>(env->numEnvs) * (shard + 1) / env->numThreads);
+    bool input[NUM_INPUTS];
+    
+    // Both are thread_local, and workers would otherwise play with the defaults
+    tuning = env->tuning;
+    mushroomFieldStrategy = env->fieldStrategy;
+    
+    for (int i = begin; i < end; ++i) {
+        loadWorldState(env->worlds[i]);
+        
+        if (env->job == JOB_RESET) {
+            initializeGame();
+        } else {
+            unsigned char action = env->actions[i];
+            for (int k = 0; k < NUM_INPUTS; ++k) {
+                input[k] = (action >> k) & 1;
+            }
+            int outcome = updateGame(input);
+            env->scores[i] = score;
+            env->dones[i] = static_cast<unsigned char>(outcome);
+            if (outcome != TICK_RUNNING) {
+                initializeGame();
+            }
+        }
+        
+        saveWorldState(env->worlds[i]);
+        writeObservation(env->observations + static_cast<size_t>(i) * OBSERVATION_SIZE);
+    }
+}
+
+static void workerLoop(VectorEnv* env, int shard) {
+    int seenGeneration = 0;
+    while (true) {
+        {
+            unique_lock<mutex> guard(env->lock);
+            env->startJob.wait(guard, [&] { return env->stopping || env->generation != seenGeneration; });
+            if (env->stopping) return;
+            seenGeneration = env->generation;
+        }
+        
+        runShard(env, shard);
+        
+        {
+            lock_guard<mutex> guard(env->lock);
+            if (--env->pendingWorkers == 0) {
+                env->jobDone.notify_one();
+            }
+        }
+    }
+}
+
+static void runJob(VectorEnv* env) {
+    if (env->numThreads > 1) {
+        lock_guard<mutex> guard(env->lock);
+        env->pendingWorkers = env->numThreads - 1;
+        env->generation++;
+        env->startJob.notify_all();
+    }
+    
+    // The calling thread takes the first shard. Its own world, hash, event
+    // sink and settings are set aside for the job and put back after.
+    saveWorldState(env->callerWorld);
+    Tuning callerTuning = tuning;
+    int callerStrategy = mushroomFieldStrategy;
+    unsigned int callerHash[NUM_HASH_FIELDS];
+    memcpy(callerHash, worldHash, sizeof(worldHash));
+    unsigned long long callerChecks = collisionChecks;
+    GameEventSink sink = gameEventSink;
+    gameEventSink = nullptr;
+    
+    runShard(env, 0);
+    
+    gameEventSink = sink;
+    collisionChecks = callerChecks;
+    tuning = callerTuning;
+    mushroomFieldStrategy = callerStrategy;
+    loadWorldState(env->callerWorld);
+    memcpy(worldHash, callerHash, sizeof(worldHash));
+    
+    if (env->numThreads > 1) {
+        unique_lock<mutex> guard(env->lock);
+        env->jobDone.wait(guard, [&] { return env->pendingWorkers == 0; });
+    }
+}
+
+VectorEnv* createVectorEnv(int numEnvs, int numThreads, unsigned int seed) {
+    if (numEnvs < 1) numEnvs = 1;
+    if (numThreads < 1) numThreads = 1;
+    if (numThreads > numEnvs) numThreads = numEnvs;
+    
+    VectorEnv* env = new VectorEnv();
+    env->numEnvs = numEnvs;
+    env->numThreads = numThreads;
+    env->worlds.resize(numEnvs);
+    env->generation = 0;
+    env->pendingWorkers = 0;
+    env->stopping = false;
+    env->tuning = tuning;
+    env->fieldStrategy = mushroomFieldStrategy;
+    
+    // Give every world its own random stream
+    for (int i = 0; i < numEnvs; ++i) {
+        memset(&env->worlds[i], 0, sizeof(WorldState));
+        env->worlds[i].centipedeStep = tuning.centipedeStep; // Loaded before the first reset
+        env->worlds[i].randomState = seed + 0x9E3779B9u * (i + 1);
+        if (env->worlds[i].randomState == 0) env->worlds[i].randomState = 1;
+    }
+    
+    for (int shard = 1; shard < numThreads; ++shard) {
+        env->workers.push_back(thread(workerLoop, env, shard));
+    }
+    return env;
+}
+
+void destroyVectorEnv(VectorEnv* env) {
+    {
+        lock_guard<mutex> guard(env->lock);
+        env->stopping = true;
+        env->startJob.notify_all();
+    }
+    for (size_t i = 0; i < env->workers.size(); ++i) {
+        env->workers[i].join();
+    }
+    delete env;
+}
+
+void resetVectorEnv(VectorEnv* env, unsigned char* observations) {
+    env->job = JOB_RESET;
+    env->observations = observations;
+    runJob(env);
+}
+
+void stepVectorEnv(VectorEnv* env, const unsigned char* actions,
+                   unsigned char* observations, int* scores, unsigned char* dones) {
+    env->job = JOB_STEP;
+    env->actions = actions;
+    env->observations = observations;
+    env->scores = scores;
+    env->dones = dones;
+    runJob(env);
+}
@@ -0,0 +1,45 @@
+#ifndef VECTOR_ENV_H
+#define VECTOR_ENV_H
+
+#include "Simulation.h"
+
+// Vectorized environment for training agents: steps many independent worlds
+// in lockstep with one action each and writes the results into buffers owned
+// by the caller. No memory is allocated after createVectorEnv.
+
+// Observation: one byte per tile, row-major [GRID_ROWS][GRID_COLS].
+// Where objects share a tile the later code in this list wins.
+const unsigned char TILE_EMPTY = 0;
+const unsigned char TILE_MUSHROOM = 1;
+const unsigned char TILE_POISON_MUSHROOM = 2;
+const unsigned char TILE_SEGMENT = 3;
+const unsigned char TILE_HEAD = 4;
+const unsigned char TILE_BULLET = 5;
+const unsigned char TILE_PLAYER = 6;
+const int OBSERVATION_SIZE = GRID_ROWS * GRID_COLS;
+
+struct VectorEnv;
+
+// numThreads includes the calling thread; 1 steps everything inline. The
+// calling thread's own world (see Simulation.h) is left as it was: reset and
+// step save it, run their share of the worlds and load it back, and its
+// events never see the vector worlds' ticks. Every world plays with the
+// tuning and field strategy the creating thread had at createVectorEnv.
+VectorEnv* createVectorEnv(int numEnvs, int numThreads, unsigned int seed);
+void destroyVectorEnv(VectorEnv* env);
+
+// Starts a new game in every world.
+// observations: numEnvs * OBSERVATION_SIZE bytes
+void resetVectorEnv(VectorEnv* env, unsigned char* observations);
+
+// Advances every world by one simulation tick (1 / TICKS_PER_SECOND seconds).
+// actions:      numEnvs bytes, each a mask of (1 << INPUT_*) bits
+// observations: numEnvs * OBSERVATION_SIZE bytes
+// scores:       numEnvs ints, the score reached this step
+// dones:        numEnvs bytes, TICK_RUNNING, TICK_PLAYER_DIED or TICK_PLAYER_WON
+// A finished world is reset at once, so its observation already shows the
+// next game while scores keeps the final score of the one that ended.
+void stepVectorEnv(VectorEnv* env, const unsigned char* actions,
+                   unsigned char* observations, int* scores, unsigned char* dones);
+
+#endif
@@ -0,0 +1,273 @@
+#include "Watchdog.h"
+#include <iostream>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+const int DUMP_NONE = 0;
+const int DUMP_FRAME_BUDGET = 1;
+const int DUMP_TICK_BUDGET = 2;
+const int DUMP_HANG = 3;
+const int DUMP_CRASH = 4;
+const char* DUMP_REASONS[] = {"none", "frame-budget", "tick-budget", "hang", "crash"};
+
+const int DUMP_COOLDOWN_SECONDS = 10; // Budget dumps are rate limited
+const int WATCHDOG_POLL_MS = 100;
+const int MAX_DUMP_DIRECTORY = 256;
+
+struct FlightRecord {
+    long long startMicros; // Since the watchdog started
+    long long phaseNanos[NUM_PHASES];
+    long long longestTickNanos;
+    int ticks;
+    int inputMask;
+    unsigned int worldTick;
+    int score;
+    int segments;
+    int groups;
+    int mushrooms;
+};
+
+FlightRecord flightRecords[FLIGHT_RECORDER_FRAMES];
+atomic<unsigned int> flightRecordCount(0); // Records finished so far; the next goes at count % size
+FlightRecord* currentRecord = &flightRecords[0];
+
+chrono::steady_clock::time_point watchdogStart;
+chrono::steady_clock::time_point lastMark;
+int frameBudget = 0;
+int tickBudget = 0;
+int hangLimit = 0;
+char dumpDirectory[MAX_DUMP_DIRECTORY] = ".";
+int dumpsWritten = 0;
+
+// Shared with the watchdog thread
+atomic<long long> lastHeartbeatMicros(0);
+atomic<bool> watchdogIdle(false);
+atomic<int> pendingDump(DUMP_NONE);
+atomic<long long> lastDumpMicros(-1000000LL * DUMP_COOLDOWN_SECONDS);
+atomic<bool> watchdogStopping(false);
+thread watchdogThread;
+
+static long long microsSinceStart() {
+    return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - watchdogStart).count();
+}
+
+// The dump only uses calls that are safe inside a signal handler:
+// no allocation, no stdio, just open, write and close.
+static char* appendText(char* out, const char* text) {
+    while (*text) *out++ = *text++;
+    return out;
+}
+
+static char* appendNumber(char* out, long long value) {
+    char digits[24];
+    int count = 0;
+    bool negative = value < 0;
+    unsigned long long magnitude = negative ? 0ULL - static_cast<unsigned long long>(value) : value;
+    do {
+        digits[count++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (negative) *out++ = '-';
+    while (count > 0) *out++ = digits[--count];
+    return out;
+}
+
+static void writeFlightDump(int reason, int detail) {
+    char path[MAX_DUMP_DIRECTORY + 64];
+    char* end = appendText(path, dumpDirectory);
+    end = appendText(end, "/flight-");
+    end = appendNumber(end, getpid());
+    end = appendText(end, "-");
+    end = appendNumber(end, dumpsWritten++);
+    end = appendText(end, "-");
+    end = appendText(end, DUMP_REASONS[reason]);
+    end = appendText(end, ".txt");
+    *end = '\0';
+    
+    int file = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file < 0) return;
+    
+    char line[512];
+    end = appendText(line, "# reason ");
+    end = appendText(end, DUMP_REASONS[reason]);
+    end = appendText(end, " detail ");
+    end = appendNumber(end, detail);
+    end = appendText(end, " at_us ");
+    end = appendNumber(end, microsSinceStart());
+    end = appendText(end, "\n# start_us events_ns input_ns sim_ns draw_ns display_ns longest_tick_ns"
+                          " ticks input world_tick score segments groups mushrooms\n");
+    write(file, line, end - line);
+    
+    unsigned int count = flightRecordCount.load(memory_order_acquire);
+    // The slot after the newest record is the frame being filled right now
+    unsigned int first = count >= FLIGHT_RECORDER_FRAMES ? count - (FLIGHT_RECORDER_FRAMES - 1) : 0;
+    for (unsigned int i = first; i < count; ++i) {
+        const FlightRecord& record = flightRecords[i % FLIGHT_RECORDER_FRAMES];
+        end = appendNumber(line, record.startMicros);
+        for (int phase = 0; phase < NUM_PHASES; ++phase) {
+            end = appendText(end, " ");
+            end = appendNumber(end, record.phaseNanos[phase]);
+        }
+        const long long fields[8] = {record.longestTickNanos, record.ticks, record.inputMask, record.worldTick,
+                                     record.score, record.segments, record.groups, record.mushrooms};
+        for (int f = 0; f < 8; ++f) {
+            end = appendText(end, " ");
+            end = appendNumber(end, fields[f]);
+        }
+        end = appendText(end, "\n");
+        write(file, line, end - line);
+    }
+    close(file);
+}
+
+static void requestDump(int reason) {
+    // The game thread only flags the dump; the watchdog thread does the I/O
+    long long now = microsSinceStart();
+    if (now - lastDumpMicros.load(memory_order_relaxed) < 1000000LL * DUMP_COOLDOWN_SECONDS) return;
+    lastDumpMicros.store(now, memory_order_relaxed);
+    int expected = DUMP_NONE;
+    pendingDump.compare_exchange_strong(expected, reason);
+}
+
+static void crashHandler(int signalNumber) {
+    writeFlightDump(DUMP_CRASH, signalNumber);
+    // SA_RESETHAND restored the default action, so this ends the process as before
+    raise(signalNumber);
+}
+
+static void watchdogLoop() {
+    bool hangReported = false;
+    while (!watchdogStopping.load(memory_order_relaxed)) {
+        this_thread::sleep_for(chrono::milliseconds(WATCHDOG_POLL_MS));
+        
+        int reason = pendingDump.exchange(DUMP_NONE);
+        if (reason != DUMP_NONE) {
+            writeFlightDump(reason, 0);
+            std::cerr << "Watchdog: " << DUMP_REASONS[reason] << " exceeded, flight record written to "
+                      << dumpDirectory << std::endl;
+        }
+        
+        long long silentMicros = microsSinceStart() - lastHeartbeatMicros.load(memory_order_relaxed);
+        if (hangLimit == 0 || watchdogIdle.load(memory_order_relaxed) ||
+            silentMicros < 1000000LL * hangLimit) {
+            hangReported = false;
+        } else if (!hangReported) {
+            // One dump per hang; it is re-armed once the game checks in again
+            hangReported = true;
+            writeFlightDump(DUMP_HANG, static_cast<int>(silentMicros / 1000));
+            std::cerr << "Watchdog: no frame for " << silentMicros / 1000 << " ms, flight record written to "
+                      << dumpDirectory << std::endl;
+        }
+    }
+}
+
+bool startWatchdog(const char* directory, int frameBudgetMicros, int tickBudgetMicros, int hangSeconds) {
+    if (strlen(directory) >= MAX_DUMP_DIRECTORY) {
+        std::cerr << "Flight record directory name is too long" << std::endl;
+        return false;
+    }
+    strcpy(dumpDirectory, directory);
+    frameBudget = frameBudgetMicros;
+    tickBudget = tickBudgetMicros;
+    hangLimit = hangSeconds;
+    watchdogStart = chrono::steady_clock::now();
+    lastMark = watchdogStart;
+    
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = crashHandler;
+    action.sa_flags = SA_RESETHAND;
+    const int crashSignals[] = {SIGSEGV, SIGABRT, SIGFPE, SIGILL, SIGBUS};
+    for (int signalNumber : crashSignals) {
+        sigaction(signalNumber, &action, nullptr);
+    }
+    
+    watchdogStopping.store(false);
+    watchdogThread = thread(watchdogLoop);
+    return true;
+}
+
+void stopWatchdog() {
+    if (!watchdogThread.joinable()) return;
+    watchdogStopping.store(true);
+    watchdogThread.join();
+}
+
+void beginFlightFrame() {
+    beginFlightFrame(chrono::steady_clock::now());
+}
+
+void beginFlightFrame(chrono::steady_clock::time_point start) {
+    lastMark = start;
+    currentRecord = &flightRecords[flightRecordCount.load(memory_order_relaxed) % FLIGHT_RECORDER_FRAMES];
+    memset(currentRecord, 0, sizeof(FlightRecord));
+    currentRecord->startMicros = chrono::duration_cast<chrono::microseconds>(lastMark - watchdogStart).count();
+}
+
+void markPhase(int phase) {
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    currentRecord->phaseNanos[phase] += chrono::duration_cast<chrono::nanoseconds>(now - lastMark).count();
+    lastMark = now;
+}
+
+void addPhaseTime(int phase, long long nanos) {
+    currentRecord->phaseNanos[phase] += nanos;
+}
+
+void noteTickTime(long long nanos) {
+    if (nanos > currentRecord->longestTickNanos) {
+        currentRecord->longestTickNanos = nanos;
+    }
+}
+
+void endFlightFrame(int ticks, const bool input[]) {
+    FlightRecord& record = *currentRecord;
+    record.ticks = ticks;
+    for (int i = 0; i < NUM_INPUTS; ++i) {
+        if (input[i]) record.inputMask |= 1 << i;
+    }
+    record.worldTick = worldTick;
+    record.score = score;
+    record.groups = groupCount;
+    // Look the thread_local grids up once; each access from here goes through a TLS wrapper
+    const int (&segments)[CENTIPEDE_LENGTH][3] = centipedeGrid;
+    const int (&mushrooms)[NUM_MUSHROOMS][5] = mushroomGrid;
+    int liveSegments = 0, liveMushrooms = 0;
+    for (int i = 0; i < CENTIPEDE_LENGTH; ++i) {
+        liveSegments += segments[i][EXISTS] != 0;
+    }
+    for (int i = 0; i < NUM_MUSHROOMS; ++i) {
+        liveMushrooms += mushrooms[i][EXISTS] != 0;
+    }
+    record.segments = liveSegments;
+    record.mushrooms = liveMushrooms;
+    // Only the game thread writes the count, so a plain store publishes the record
+    flightRecordCount.store(flightRecordCount.load(memory_order_relaxed) + 1, memory_order_release);
+    // The last phase mark is recent enough for a heartbeat and saves a clock read
+    lastHeartbeatMicros.store(chrono::duration_cast<chrono::microseconds>(lastMark - watchdogStart).count(),
+                              memory_order_relaxed);
+    
+    long long frameNanos = 0;
+    for (int phase = 0; phase < NUM_PHASES; ++phase) {
+        frameNanos += record.phaseNanos[phase];
+    }
+    if (frameBudget > 0 && frameNanos > 1000LL * frameBudget) {
+        requestDump(DUMP_FRAME_BUDGET);
+    } else if (tickBudget > 0 && record.longestTickNanos > 1000LL * tickBudget) {
+        requestDump(DUMP_TICK_BUDGET);
+    }
+}
+
+void setWatchdogIdle(bool idle) {
+    watchdogIdle.store(idle, memory_order_relaxed);
+    if (!idle) {
+        lastHeartbeatMicros.store(microsSinceStart(), memory_order_relaxed);
+    }
+}
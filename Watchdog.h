@@ -0,0 +1,39 @@
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include "Simulation.h"
+#include <chrono>
+
+// Flight recorder and watchdog. The game thread fills one record per frame
+// (per tick when headless) in a fixed ring holding the last few seconds:
+// phase timings, input and world stats. The ring is written to a text file
+// in the dump directory when a frame or tick goes over budget, when the game
+// thread stops checking in (a hang), or when the process gets a crash signal.
+// Dumps are written by the watchdog thread or the signal handler, never by
+// the game thread.
+
+const int FLIGHT_RECORDER_FRAMES = 1024;
+
+// Where the time of a frame went
+const int PHASE_EVENTS = 0;
+const int PHASE_INPUT = 1; // Reading the keyboard or the autopilot's lookahead
+const int PHASE_SIMULATION = 2;
+const int PHASE_DRAW = 3;
+const int PHASE_DISPLAY = 4;
+const int NUM_PHASES = 5;
+
+// A budget of 0 turns that check off
+bool startWatchdog(const char* dumpDirectory, int frameBudgetMicros, int tickBudgetMicros, int hangSeconds);
+void stopWatchdog();
+
+void beginFlightFrame();
+void beginFlightFrame(std::chrono::steady_clock::time_point start); // For callers that already read the clock
+void markPhase(int phase); // Charges the time since the last mark to phase
+void addPhaseTime(int phase, long long nanos);
+void noteTickTime(long long nanos); // Checked against the tick budget
+// Closes the record with the last tick's input and the world as it is now,
+// checks the budgets, and tells the watchdog the game is still alive
+void endFlightFrame(int ticks, const bool input[]);
+void setWatchdogIdle(bool idle); // Set while blocked waiting for input on purpose
+
+#endif